@@ -114,6 +114,7 @@ namespace macdap
         void set_event_loop_handle(esp_event_loop_handle_t event_loop_handle);
         gps_t get_gps_data();
         esp_err_t add_lv_obj_icon(lv_obj_t *lv_obj_icon);
+        uint32_t get_suppressed_updates();
         esp_err_t register_event_handler(esp_event_handler_t event_handler, void* handler_arg = nullptr);
         esp_err_t unregister_event_handler(esp_event_handler_t event_handler);
     };
@@ -38,6 +38,7 @@ static const char *TAG = "gps";
 ESP_EVENT_DEFINE_BASE(GPS_EVENTS);
 
 static esp_gps_t *_esp_gps = NULL;
+static uint32_t _suppressed_updates = 0;
 
 static float parse_lat_long(esp_gps_t *esp_gps)
 {
@@ -95,7 +96,11 @@ static void update_status(lv_obj_t *icon, gps_t *gps)
     }
     if (icon_src != nullptr) {
         if (lvgl_port_lock(0)) {
-            lv_img_set_src(icon, icon_src);
+            if (lv_image_get_src(icon) != icon_src) {
+                lv_img_set_src(icon, icon_src);
+            } else {
+                _suppressed_updates++;
+            }
             lvgl_port_unlock();
         }
     }
@@ -875,6 +880,12 @@ gps_t GPS::get_gps_data()
     return empty_gps;
 }
 
+// Icon updates skipped because the icon already showed the status
+uint32_t GPS::get_suppressed_updates()
+{
+    return _suppressed_updates;
+}
+
 esp_err_t GPS::add_lv_obj_icon(lv_obj_t *lv_obj_icon)
 {
     if (lv_obj_icon == nullptr) {
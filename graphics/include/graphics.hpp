@@ -41,9 +41,16 @@ namespace macdap
     {
 
     private:
+        uint32_t m_suppressed_updates;
+
         Graphics();
         ~Graphics();
 
+        lv_obj_t *create_status_icon(lv_display_t *display, const lv_image_dsc_t *icon_src, int32_t x, int32_t y);
+        lv_obj_t *create_status_icon_locked(lv_display_t *display, const lv_image_dsc_t *icon_src, int32_t x, int32_t y);
+        bool update_status_icon(lv_obj_t *icon_widget, const lv_image_dsc_t *icon_src);
+        bool update_status_icon_locked(lv_obj_t *icon_widget, const lv_image_dsc_t *icon_src);
+
     public:
         Graphics(Graphics const&) = delete;
         void operator=(Graphics const &) = delete;
@@ -53,6 +60,25 @@ namespace macdap
             return instance;
         }
 
+        // Holds the LVGL lock for its lifetime, so that the *_locked calls made meanwhile are rendered together.
+        // Given a display, its invalidation is suspended until the batch ends and the active screen is then invalidated
+        // once, which suits building a screen rather than updating a few widgets.
+        class Batch
+        {
+        public:
+            explicit Batch(lv_display_t *display = nullptr, uint32_t ms_timeout = 0);
+            ~Batch();
+            Batch(Batch const&) = delete;
+            void operator=(Batch const &) = delete;
+
+            // False when the lock could not be taken within the timeout
+            explicit operator bool() const { return m_locked; }
+
+        private:
+            lv_display_t *m_display;
+            bool m_locked;
+        };
+
         esp_err_t init(lv_display_t *display);
         bool seize_lvgl(uint32_t ms_timeout = 0);
         void release_lvgl(void);
@@ -78,6 +104,30 @@ namespace macdap
         // Status icon update methods (for existing icons)
         bool update_wifi_status_icon(lv_obj_t *icon_widget, WifiStatus status, IconSize size = IconSize::SIZE_16);
         bool update_cellular_status_icon(lv_obj_t *icon_widget, CellularStatus status, IconSize size = IconSize::SIZE_16);
-        
+
+        // Updates skipped because the widget already showed the message or icon, setting it again would still invalidate
+        // and redraw it. Counted under the LVGL lock.
+        uint32_t get_suppressed_updates() { return m_suppressed_updates; }
+        // For the other widgets of this component that skip updates the same way, called under the LVGL lock
+        void count_suppressed_update() { m_suppressed_updates++; }
+
+        // Same as above for a caller already holding the LVGL lock, within a Batch or between seize_lvgl and release_lvgl
+        void clear_locked(lv_display_t *display);
+        void background_locked(lv_display_t *display, lv_color_t color);
+        void delete_widget_locked(lv_obj_t *widget);
+        lv_obj_t *logo_locked(lv_display_t *display, const void *src, lv_style_t *style = nullptr);
+        void qrcode_locked(lv_display_t *display, const char *data, lv_color_t light_color = lv_color_white(), lv_color_t dark_color = lv_color_black());
+        void dot_locked(lv_display_t *display, lv_style_t *style = nullptr, int32_t x = 0, int32_t y = 0);
+        void horizontal_locked(lv_display_t *display, lv_style_t *style = nullptr);
+        void vertical_locked(lv_display_t *display, lv_style_t *style = nullptr);
+        void cross_locked(lv_display_t *display, lv_style_t *style = nullptr);
+        void spinner_locked(lv_display_t *display, int32_t size, lv_style_t *style = nullptr);
+        lv_obj_t *led_locked(lv_display_t *display, int32_t size, lv_color_t color);
+        lv_obj_t *create_message_locked(lv_display_t *display, const char *message = "", lv_style_t *style = nullptr, lv_label_long_mode_t long_mode = LV_LABEL_LONG_SCROLL_CIRCULAR);
+        bool update_message_locked(lv_obj_t *message_widget, const char *message);
+        lv_obj_t *create_wifi_status_icon_locked(lv_display_t *display, WifiStatus status, IconSize size = IconSize::SIZE_16, int32_t x = 0, int32_t y = 0);
+        lv_obj_t *create_cellular_status_icon_locked(lv_display_t *display, CellularStatus status, IconSize size = IconSize::SIZE_16, int32_t x = 0, int32_t y = 0);
+        bool update_wifi_status_icon_locked(lv_obj_t *icon_widget, WifiStatus status, IconSize size = IconSize::SIZE_16);
+        bool update_cellular_status_icon_locked(lv_obj_t *icon_widget, CellularStatus status, IconSize size = IconSize::SIZE_16);
     };
 }
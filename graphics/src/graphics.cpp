@@ -6,7 +6,38 @@ using namespace macdap;
 
 static const char *TAG = "graphics";
 
-Graphics::Graphics()
+// Status icons by status then size, in the order of the enums, the first row standing in for an unknown status
+static constexpr const lv_image_dsc_t *_wifi_icons[][2] = {
+    {&wifi_none_16, &wifi_none_32},             // WifiStatus::NONE
+    {&wifi_low_16, &wifi_low_32},               // WifiStatus::LOW
+    {&wifi_medium_16, &wifi_medium_32},         // WifiStatus::MEDIUM
+    {&wifi_high_16, &wifi_high_32},             // WifiStatus::HIGH
+    {&wifi_slash_16, &wifi_slash_32},           // WifiStatus::DISCONNECTED_SLASH
+    {&wifi_x_16, &wifi_x_32},                   // WifiStatus::DISCONNECTED_X
+    {&broadcast_16, &broadcast_32}              // WifiStatus::BROADCAST
+};
+static_assert(sizeof(_wifi_icons) / sizeof(_wifi_icons[0]) == static_cast<size_t>(WifiStatus::BROADCAST) + 1, "One row per WifiStatus");
+
+static constexpr const lv_image_dsc_t *_cellular_icons[][2] = {
+    {&cell_signal_none_16, &cell_signal_none_32},       // CellularStatus::NONE
+    {&cell_signal_low_16, &cell_signal_low_32},         // CellularStatus::LOW
+    {&cell_signal_medium_16, &cell_signal_medium_32},   // CellularStatus::MEDIUM
+    {&cell_signal_high_16, &cell_signal_high_32},       // CellularStatus::HIGH
+    {&cell_signal_full_16, &cell_signal_full_32},       // CellularStatus::FULL
+    {&cell_signal_slash_16, &cell_signal_slash_32},     // CellularStatus::DISCONNECTED_SLASH
+    {&cell_signal_x_16, &cell_signal_x_32}              // CellularStatus::DISCONNECTED_X
+};
+static_assert(sizeof(_cellular_icons) / sizeof(_cellular_icons[0]) == static_cast<size_t>(CellularStatus::DISCONNECTED_X) + 1, "One row per CellularStatus");
+
+template <typename status_t, size_t STATUS_NB>
+static constexpr const lv_image_dsc_t *lookup_icon(const lv_image_dsc_t *const (&icons)[STATUS_NB][2], status_t status, IconSize size)
+{
+    const size_t row = static_cast<size_t>(status) < STATUS_NB ? static_cast<size_t>(status) : 0;
+    return icons[row][size == IconSize::SIZE_32 ? 1 : 0];
+}
+
+Graphics::Graphics() :
+    m_suppressed_updates(0)
 {
     ESP_LOGI(TAG, "Initializing...");
 
@@ -18,6 +49,31 @@ Graphics::~Graphics()
 {
 }
 
+Graphics::Batch::Batch(lv_display_t *display, uint32_t ms_timeout) :
+    m_display(display),
+    m_locked(Graphics::get_instance().seize_lvgl(ms_timeout))
+{
+    if (m_locked && m_display != nullptr)
+    {
+        lv_display_enable_invalidation(m_display, false);
+    }
+}
+
+Graphics::Batch::~Batch()
+{
+    if (!m_locked)
+    {
+        return;
+    }
+
+    if (m_display != nullptr)
+    {
+        lv_display_enable_invalidation(m_display, true);
+        lv_obj_invalidate(lv_display_get_screen_active(m_display));
+    }
+    Graphics::get_instance().release_lvgl();
+}
+
 esp_err_t Graphics::init(lv_display_t *display)
 {
     ESP_LOGI(TAG, "Init display");
@@ -45,39 +101,54 @@ void Graphics::clear(lv_display_t *display)
 {
     if (seize_lvgl())
     {
-        lv_obj_t *screen = lv_display_get_screen_active(display);
-
-        lv_obj_clean(screen);
+        clear_locked(display);
         release_lvgl();
     }
 }
 
+void Graphics::clear_locked(lv_display_t *display)
+{
+    lv_obj_t *screen = lv_display_get_screen_active(display);
+
+    lv_obj_clean(screen);
+}
+
 void Graphics::background(lv_display_t *display, lv_color_t color)
 {
     if (seize_lvgl())
     {
-        lv_obj_t *screen = lv_display_get_screen_active(display);
-
-        lv_obj_set_style_bg_color(screen, color, LV_PART_MAIN);
+        background_locked(display, color);
         release_lvgl();
     }
 }
 
+void Graphics::background_locked(lv_display_t *display, lv_color_t color)
+{
+    lv_obj_t *screen = lv_display_get_screen_active(display);
+
+    lv_obj_set_style_bg_color(screen, color, LV_PART_MAIN);
+}
+
 lv_obj_t *Graphics::logo(lv_display_t *display, const void *src, lv_style_t *style)
 {
     lv_obj_t *logo = nullptr;
 
     if (seize_lvgl())
     {
-        lv_obj_t *screen = lv_display_get_screen_active(display);
+        logo = logo_locked(display, src, style);
+        release_lvgl();
+    }
+    return logo;
+}
 
-        logo = lv_image_create(screen);
-        lv_image_set_src(logo, src);
-        if (style != nullptr) {
-            lv_obj_add_style(logo, style, LV_STATE_DEFAULT);
-        }
+lv_obj_t *Graphics::logo_locked(lv_display_t *display, const void *src, lv_style_t *style)
+{
+    lv_obj_t *screen = lv_display_get_screen_active(display);
 
-        release_lvgl();
+    lv_obj_t *logo = lv_image_create(screen);
+    lv_image_set_src(logo, src);
+    if (style != nullptr) {
+        lv_obj_add_style(logo, style, LV_STATE_DEFAULT);
     }
     return logo;
 }
@@ -87,20 +158,28 @@ void Graphics::qrcode(lv_display_t *display, const char *data, lv_color_t light_
 #ifdef CONFIG_LV_USE_QRCODE
     if (seize_lvgl())
     {
-        lv_obj_t *screen = lv_display_get_screen_active(display);
-        int32_t height = lv_display_get_vertical_resolution(display);
+        qrcode_locked(display, data, light_color, dark_color);
+        release_lvgl();
+    }
+#else
+    ESP_LOGW(TAG, "QR Code support is not enabled in LVGL configuration.");
+#endif
+}
 
-        lv_obj_t *qr = lv_qrcode_create(screen);
-        lv_qrcode_set_size(qr, height);
-        lv_qrcode_set_dark_color(qr, dark_color);
-        lv_qrcode_set_light_color(qr, light_color);
+void Graphics::qrcode_locked(lv_display_t *display, const char *data, lv_color_t light_color, lv_color_t dark_color)
+{
+#ifdef CONFIG_LV_USE_QRCODE
+    lv_obj_t *screen = lv_display_get_screen_active(display);
+    int32_t height = lv_display_get_vertical_resolution(display);
 
-        lv_qrcode_update(qr, data, strlen(data));
-        lv_obj_center(qr);
-        lv_obj_align(qr, LV_ALIGN_LEFT_MID, 0, 0);
+    lv_obj_t *qr = lv_qrcode_create(screen);
+    lv_qrcode_set_size(qr, height);
+    lv_qrcode_set_dark_color(qr, dark_color);
+    lv_qrcode_set_light_color(qr, light_color);
 
-        release_lvgl();
-    }
+    lv_qrcode_update(qr, data, strlen(data));
+    lv_obj_center(qr);
+    lv_obj_align(qr, LV_ALIGN_LEFT_MID, 0, 0);
 #else
     ESP_LOGW(TAG, "QR Code support is not enabled in LVGL configuration.");
 #endif
@@ -110,15 +189,19 @@ void Graphics::dot(lv_display_t *display, lv_style_t *style, int32_t x, int32_t
 {
     if (seize_lvgl())
     {
-        lv_obj_t *screen = lv_display_get_screen_active(display);
+        dot_locked(display, style, x, y);
+        release_lvgl();
+    }
+}
 
-        lv_obj_t *dot = lv_obj_create(screen);
-        lv_obj_set_size(dot, x, y);
-        if (style != nullptr) {
-            lv_obj_add_style(dot, style, LV_STATE_DEFAULT);
-        }
+void Graphics::dot_locked(lv_display_t *display, lv_style_t *style, int32_t x, int32_t y)
+{
+    lv_obj_t *screen = lv_display_get_screen_active(display);
 
-        release_lvgl();
+    lv_obj_t *dot = lv_obj_create(screen);
+    lv_obj_set_size(dot, x, y);
+    if (style != nullptr) {
+        lv_obj_add_style(dot, style, LV_STATE_DEFAULT);
     }
 }
 
@@ -126,67 +209,81 @@ void Graphics::horizontal(lv_display_t *display, lv_style_t *style)
 {
     if (seize_lvgl())
     {
-        lv_obj_t *screen = lv_display_get_screen_active(display);
+        horizontal_locked(display, style);
+        release_lvgl();
+    }
+}
 
-        int32_t width = lv_display_get_horizontal_resolution(display);
-        int32_t height = lv_display_get_vertical_resolution(display);
+void Graphics::horizontal_locked(lv_display_t *display, lv_style_t *style)
+{
+    lv_obj_t *screen = lv_display_get_screen_active(display);
 
-        lv_point_precise_t horizontal_line_points[] = { {0, height/2}, {width, height/2} };
+    int32_t width = lv_display_get_horizontal_resolution(display);
+    int32_t height = lv_display_get_vertical_resolution(display);
 
-        lv_obj_t *horizontal_line = lv_line_create(screen);
-        lv_line_set_points(horizontal_line, horizontal_line_points, 2);
-        if (style != nullptr) {
-            lv_obj_add_style(horizontal_line, style, LV_STATE_DEFAULT);
-        }
+    lv_point_precise_t horizontal_line_points[] = { {0, height/2}, {width, height/2} };
 
-        release_lvgl();
+    lv_obj_t *horizontal_line = lv_line_create(screen);
+    lv_line_set_points(horizontal_line, horizontal_line_points, 2);
+    if (style != nullptr) {
+        lv_obj_add_style(horizontal_line, style, LV_STATE_DEFAULT);
     }
 }
+
 void Graphics::vertical(lv_display_t *display, lv_style_t *style)
 {
     if (seize_lvgl())
     {
-        lv_obj_t *screen = lv_display_get_screen_active(display);
+        vertical_locked(display, style);
+        release_lvgl();
+    }
+}
 
-        int32_t width = lv_display_get_horizontal_resolution(display);
-        int32_t height = lv_display_get_vertical_resolution(display);
+void Graphics::vertical_locked(lv_display_t *display, lv_style_t *style)
+{
+    lv_obj_t *screen = lv_display_get_screen_active(display);
 
-        lv_point_precise_t vertical_line_points[] = { {width/2, 0}, {width/2, height} };
+    int32_t width = lv_display_get_horizontal_resolution(display);
+    int32_t height = lv_display_get_vertical_resolution(display);
 
-        lv_obj_t *vertical_line = lv_line_create(screen);
-        lv_line_set_points(vertical_line, vertical_line_points, 2);
-        if (style != nullptr) {
-            lv_obj_add_style(vertical_line, style, LV_STATE_DEFAULT);
-        }
+    lv_point_precise_t vertical_line_points[] = { {width/2, 0}, {width/2, height} };
 
-        release_lvgl();
+    lv_obj_t *vertical_line = lv_line_create(screen);
+    lv_line_set_points(vertical_line, vertical_line_points, 2);
+    if (style != nullptr) {
+        lv_obj_add_style(vertical_line, style, LV_STATE_DEFAULT);
     }
 }
+
 void Graphics::cross(lv_display_t *display, lv_style_t *style)
 {
     if (seize_lvgl())
     {
-        lv_obj_t *screen = lv_display_get_screen_active(display);
+        cross_locked(display, style);
+        release_lvgl();
+    }
+}
 
-        int32_t width = lv_display_get_horizontal_resolution(display);
-        int32_t height = lv_display_get_vertical_resolution(display);
+void Graphics::cross_locked(lv_display_t *display, lv_style_t *style)
+{
+    lv_obj_t *screen = lv_display_get_screen_active(display);
 
-        lv_point_precise_t line_1_points[] = { {0, 0}, {width, height} };
-        lv_point_precise_t line_2_points[] = { {0, height}, {width, 0} };
+    int32_t width = lv_display_get_horizontal_resolution(display);
+    int32_t height = lv_display_get_vertical_resolution(display);
 
-        lv_obj_t *line1 = lv_line_create(screen);
-        lv_line_set_points(line1, line_1_points, 2);
-        if (style != nullptr) {
-            lv_obj_add_style(line1, style, LV_STATE_DEFAULT);
-        }
+    lv_point_precise_t line_1_points[] = { {0, 0}, {width, height} };
+    lv_point_precise_t line_2_points[] = { {0, height}, {width, 0} };
 
-        lv_obj_t *line2 = lv_line_create(screen);
-        lv_line_set_points(line2, line_2_points, 2);
-        if (style != nullptr) {
-            lv_obj_add_style(line2, style, LV_STATE_DEFAULT);
-        }
+    lv_obj_t *line1 = lv_line_create(screen);
+    lv_line_set_points(line1, line_1_points, 2);
+    if (style != nullptr) {
+        lv_obj_add_style(line1, style, LV_STATE_DEFAULT);
+    }
 
-        release_lvgl();
+    lv_obj_t *line2 = lv_line_create(screen);
+    lv_line_set_points(line2, line_2_points, 2);
+    if (style != nullptr) {
+        lv_obj_add_style(line2, style, LV_STATE_DEFAULT);
     }
 }
 
@@ -194,16 +291,20 @@ void Graphics::spinner(lv_display_t *display, int32_t size, lv_style_t *style)
 {
     if (seize_lvgl())
     {
-        lv_obj_t *screen = lv_display_get_screen_active(display);
+        spinner_locked(display, size, style);
+        release_lvgl();
+    }
+}
 
-        lv_obj_t *spinner = lv_spinner_create(screen);
-        if (style != nullptr) {
-            lv_obj_add_style(spinner, style, LV_STATE_DEFAULT);
-        }
-        lv_obj_set_size(spinner, size, size);
+void Graphics::spinner_locked(lv_display_t *display, int32_t size, lv_style_t *style)
+{
+    lv_obj_t *screen = lv_display_get_screen_active(display);
 
-        release_lvgl();
+    lv_obj_t *spinner = lv_spinner_create(screen);
+    if (style != nullptr) {
+        lv_obj_add_style(spinner, style, LV_STATE_DEFAULT);
     }
+    lv_obj_set_size(spinner, size, size);
 }
 
 lv_obj_t *Graphics::led(lv_display_t *display, int32_t size, lv_color_t color)
@@ -212,48 +313,66 @@ lv_obj_t *Graphics::led(lv_display_t *display, int32_t size, lv_color_t color)
 
     if (seize_lvgl())
     {
-        lv_obj_t *screen = lv_display_get_screen_active(display);
-
-        led = lv_led_create(screen);
-        lv_obj_set_size(led, size, size);
-        lv_obj_align(led, LV_ALIGN_CENTER, 0, 0);
-        lv_led_set_color(led, color);
-        lv_led_off(led);
-
+        led = led_locked(display, size, color);
         release_lvgl();
     }
     return led;
 }
 
+lv_obj_t *Graphics::led_locked(lv_display_t *display, int32_t size, lv_color_t color)
+{
+    lv_obj_t *screen = lv_display_get_screen_active(display);
+
+    lv_obj_t *led = lv_led_create(screen);
+    lv_obj_set_size(led, size, size);
+    lv_obj_align(led, LV_ALIGN_CENTER, 0, 0);
+    lv_led_set_color(led, color);
+    lv_led_off(led);
+    return led;
+}
+
 void Graphics::delete_widget(lv_obj_t *widget)
 {
     if (widget != nullptr)
     {
         if (seize_lvgl())
         {
-            lv_obj_delete(widget);
+            delete_widget_locked(widget);
             release_lvgl();
         }
     }
 }
 
+void Graphics::delete_widget_locked(lv_obj_t *widget)
+{
+    if (widget != nullptr)
+    {
+        lv_obj_delete(widget);
+    }
+}
+
 lv_obj_t *Graphics::create_message(lv_display_t *display, const char *message, lv_style_t *style, lv_label_long_mode_t long_mode)
 {
     lv_obj_t *label = nullptr;
 
     if (seize_lvgl())
     {
-        lv_obj_t *screen = lv_display_get_screen_active(display);
+        label = create_message_locked(display, message, style, long_mode);
+        release_lvgl();
+    }
+    return label;
+}
 
-        label = lv_label_create(screen);
-        if (style != nullptr) {
-            lv_obj_add_style(label, style, LV_STATE_DEFAULT);
-        }
-        lv_label_set_long_mode(label, long_mode);
-        lv_label_set_text(label, message);
+lv_obj_t *Graphics::create_message_locked(lv_display_t *display, const char *message, lv_style_t *style, lv_label_long_mode_t long_mode)
+{
+    lv_obj_t *screen = lv_display_get_screen_active(display);
 
-        release_lvgl();
+    lv_obj_t *label = lv_label_create(screen);
+    if (style != nullptr) {
+        lv_obj_add_style(label, style, LV_STATE_DEFAULT);
     }
+    lv_label_set_long_mode(label, long_mode);
+    lv_label_set_text(label, message);
     return label;
 }
 
@@ -263,186 +382,109 @@ bool Graphics::update_message(lv_obj_t *message_widget, const char *message)
 
     if (seize_lvgl())
     {
-        lv_label_set_text(message_widget, message);
+        update_message_locked(message_widget, message);
         release_lvgl();
         return true;
     }
     return false;
 }
 
-lv_obj_t *Graphics::create_wifi_status_icon(lv_display_t *display, WifiStatus status, IconSize size, int32_t x, int32_t y)
+bool Graphics::update_message_locked(lv_obj_t *message_widget, const char *message)
 {
-    const lv_image_dsc_t *icon_src = nullptr;
-    
-    if (size == IconSize::SIZE_32)
-    {
-        switch (status)
-        {
-            case WifiStatus::NONE:                  icon_src = &wifi_none_32; break;
-            case WifiStatus::LOW:                   icon_src = &wifi_low_32; break;
-            case WifiStatus::MEDIUM:                icon_src = &wifi_medium_32; break;
-            case WifiStatus::HIGH:                  icon_src = &wifi_high_32; break;
-            case WifiStatus::DISCONNECTED_SLASH:    icon_src = &wifi_slash_32; break;
-            case WifiStatus::DISCONNECTED_X:        icon_src = &wifi_x_32; break;
-            case WifiStatus::BROADCAST:             icon_src = &broadcast_32; break;
-            default:                                icon_src = &wifi_none_32; break;
-        }
-    }
-    else
-    {
-        switch (status)
-        {
-            case WifiStatus::NONE:                  icon_src = &wifi_none_16; break;
-            case WifiStatus::LOW:                   icon_src = &wifi_low_16; break;
-            case WifiStatus::MEDIUM:                icon_src = &wifi_medium_16; break;
-            case WifiStatus::HIGH:                  icon_src = &wifi_high_16; break;
-            case WifiStatus::DISCONNECTED_SLASH:    icon_src = &wifi_slash_16; break;
-            case WifiStatus::DISCONNECTED_X:        icon_src = &wifi_x_16; break;
-            case WifiStatus::BROADCAST:             icon_src = &broadcast_16; break;
-            default:                                icon_src = &wifi_none_16; break;
-        }
-    }
-    
-    if (seize_lvgl())
+    if (message_widget == nullptr || message == nullptr) return false;
+
+    // The label is left alone when unchanged, setting it would redraw it anyway
+    if (strcmp(lv_label_get_text(message_widget), message) == 0)
     {
-        lv_obj_t *icon = lv_img_create(lv_display_get_screen_active(display));
-        lv_img_set_src(icon, icon_src);
-        lv_obj_set_pos(icon, x, y);
-        release_lvgl();
-        return icon;
+        m_suppressed_updates++;
+        return true;
     }
-    return nullptr;
+    lv_label_set_text(message_widget, message);
+    return true;
+}
+
+lv_obj_t *Graphics::create_wifi_status_icon(lv_display_t *display, WifiStatus status, IconSize size, int32_t x, int32_t y)
+{
+    return create_status_icon(display, lookup_icon(_wifi_icons, status, size), x, y);
+}
+
+lv_obj_t *Graphics::create_wifi_status_icon_locked(lv_display_t *display, WifiStatus status, IconSize size, int32_t x, int32_t y)
+{
+    return create_status_icon_locked(display, lookup_icon(_wifi_icons, status, size), x, y);
 }
 
 bool Graphics::update_wifi_status_icon(lv_obj_t *icon_widget, WifiStatus status, IconSize size)
 {
-    if (!icon_widget) return false;
-    
-    const lv_image_dsc_t *icon_src = nullptr;
-    
-    if (size == IconSize::SIZE_32)
-    {
-        switch (status)
-        {
-            case WifiStatus::NONE:                  icon_src = &wifi_none_32; break;
-            case WifiStatus::LOW:                   icon_src = &wifi_low_32; break;
-            case WifiStatus::MEDIUM:                icon_src = &wifi_medium_32; break;
-            case WifiStatus::HIGH:                  icon_src = &wifi_high_32; break;
-            case WifiStatus::DISCONNECTED_SLASH:    icon_src = &wifi_slash_32; break;
-            case WifiStatus::DISCONNECTED_X:        icon_src = &wifi_x_32; break;
-            case WifiStatus::BROADCAST:             icon_src = &broadcast_32; break;
-            default:                                icon_src = &wifi_none_32; break;
-        }
-    }
-    else
-    {
-        switch (status)
-        {
-            case WifiStatus::NONE:                  icon_src = &wifi_none_16; break;
-            case WifiStatus::LOW:                   icon_src = &wifi_low_16; break;
-            case WifiStatus::MEDIUM:                icon_src = &wifi_medium_16; break;
-            case WifiStatus::HIGH:                  icon_src = &wifi_high_16; break;
-            case WifiStatus::DISCONNECTED_SLASH:    icon_src = &wifi_slash_16; break;
-            case WifiStatus::DISCONNECTED_X:        icon_src = &wifi_x_16; break;
-            case WifiStatus::BROADCAST:             icon_src = &broadcast_16; break;
-            default:                                icon_src = &wifi_none_16; break;
-        }
-    }
-    
-    if (seize_lvgl())
-    {
-        lv_img_set_src(icon_widget, icon_src);
-        release_lvgl();
-        return true;
-    }
-    return false;
+    return update_status_icon(icon_widget, lookup_icon(_wifi_icons, status, size));
+}
+
+bool Graphics::update_wifi_status_icon_locked(lv_obj_t *icon_widget, WifiStatus status, IconSize size)
+{
+    return update_status_icon_locked(icon_widget, lookup_icon(_wifi_icons, status, size));
 }
 
 lv_obj_t *Graphics::create_cellular_status_icon(lv_display_t *display, CellularStatus status, IconSize size, int32_t x, int32_t y)
 {
-    const lv_image_dsc_t *icon_src = nullptr;
-    
-    if (size == IconSize::SIZE_32)
-    {
-        switch (status)
-        {
-            case CellularStatus::NONE:                  icon_src = &cell_signal_none_32; break;
-            case CellularStatus::LOW:                   icon_src = &cell_signal_low_32; break;
-            case CellularStatus::MEDIUM:                icon_src = &cell_signal_medium_32; break;
-            case CellularStatus::HIGH:                  icon_src = &cell_signal_high_32; break;
-            case CellularStatus::FULL:                  icon_src = &cell_signal_full_32; break;
-            case CellularStatus::DISCONNECTED_SLASH:    icon_src = &cell_signal_slash_32; break;
-            case CellularStatus::DISCONNECTED_X:        icon_src = &cell_signal_x_32; break;
-            default:                                    icon_src = &cell_signal_none_32; break;
-        }
-    }
-    else
-    {
-        switch (status)
-        {
-            case CellularStatus::NONE:                  icon_src = &cell_signal_none_16; break;
-            case CellularStatus::LOW:                   icon_src = &cell_signal_low_16; break;
-            case CellularStatus::MEDIUM:                icon_src = &cell_signal_medium_16; break;
-            case CellularStatus::HIGH:                  icon_src = &cell_signal_high_16; break;
-            case CellularStatus::FULL:                  icon_src = &cell_signal_full_16; break;
-            case CellularStatus::DISCONNECTED_SLASH:    icon_src = &cell_signal_slash_16; break;
-            case CellularStatus::DISCONNECTED_X:        icon_src = &cell_signal_x_16; break;
-            default:                                    icon_src = &cell_signal_none_16; break;
-        }
-    }
-    
+    return create_status_icon(display, lookup_icon(_cellular_icons, status, size), x, y);
+}
+
+lv_obj_t *Graphics::create_cellular_status_icon_locked(lv_display_t *display, CellularStatus status, IconSize size, int32_t x, int32_t y)
+{
+    return create_status_icon_locked(display, lookup_icon(_cellular_icons, status, size), x, y);
+}
+
+bool Graphics::update_cellular_status_icon(lv_obj_t *icon_widget, CellularStatus status, IconSize size)
+{
+    return update_status_icon(icon_widget, lookup_icon(_cellular_icons, status, size));
+}
+
+bool Graphics::update_cellular_status_icon_locked(lv_obj_t *icon_widget, CellularStatus status, IconSize size)
+{
+    return update_status_icon_locked(icon_widget, lookup_icon(_cellular_icons, status, size));
+}
+
+lv_obj_t *Graphics::create_status_icon(lv_display_t *display, const lv_image_dsc_t *icon_src, int32_t x, int32_t y)
+{
+    lv_obj_t *icon = nullptr;
+
     if (seize_lvgl())
     {
-        lv_obj_t *icon = lv_img_create(lv_display_get_screen_active(display));
-        lv_img_set_src(icon, icon_src);
-        lv_obj_set_pos(icon, x, y);
+        icon = create_status_icon_locked(display, icon_src, x, y);
         release_lvgl();
-        return icon;
     }
-    return nullptr;
+    return icon;
 }
 
-bool Graphics::update_cellular_status_icon(lv_obj_t *icon_widget, CellularStatus status, IconSize size)
+lv_obj_t *Graphics::create_status_icon_locked(lv_display_t *display, const lv_image_dsc_t *icon_src, int32_t x, int32_t y)
+{
+    lv_obj_t *icon = lv_img_create(lv_display_get_screen_active(display));
+    lv_img_set_src(icon, icon_src);
+    lv_obj_set_pos(icon, x, y);
+    return icon;
+}
+
+bool Graphics::update_status_icon(lv_obj_t *icon_widget, const lv_image_dsc_t *icon_src)
 {
     if (!icon_widget) return false;
-    
-    const lv_image_dsc_t *icon_src = nullptr;
-    
-    if (size == IconSize::SIZE_32)
-    {
-        switch (status)
-        {
-            case CellularStatus::NONE:                  icon_src = &cell_signal_none_32; break;
-            case CellularStatus::LOW:                   icon_src = &cell_signal_low_32; break;
-            case CellularStatus::MEDIUM:                icon_src = &cell_signal_medium_32; break;
-            case CellularStatus::HIGH:                  icon_src = &cell_signal_high_32; break;
-            case CellularStatus::FULL:                  icon_src = &cell_signal_full_32; break;
-            case CellularStatus::DISCONNECTED_SLASH:    icon_src = &cell_signal_slash_32; break;
-            case CellularStatus::DISCONNECTED_X:        icon_src = &cell_signal_x_32; break;
-            default:                                    icon_src = &cell_signal_none_32; break;
-        }
-    }
-    else
-    {
-        switch (status)
-        {
-            case CellularStatus::NONE:                  icon_src = &cell_signal_none_16; break;
-            case CellularStatus::LOW:                   icon_src = &cell_signal_low_16; break;
-            case CellularStatus::MEDIUM:                icon_src = &cell_signal_medium_16; break;
-            case CellularStatus::HIGH:                  icon_src = &cell_signal_high_16; break;
-            case CellularStatus::FULL:                  icon_src = &cell_signal_full_16; break;
-            case CellularStatus::DISCONNECTED_SLASH:    icon_src = &cell_signal_slash_16; break;
-            case CellularStatus::DISCONNECTED_X:        icon_src = &cell_signal_x_16; break;
-            default:                                    icon_src = &cell_signal_none_16; break;
-        }
-    }
-    
+
     if (seize_lvgl())
     {
-        lv_img_set_src(icon_widget, icon_src);
+        update_status_icon_locked(icon_widget, icon_src);
         release_lvgl();
         return true;
     }
     return false;
 }
 
+bool Graphics::update_status_icon_locked(lv_obj_t *icon_widget, const lv_image_dsc_t *icon_src)
+{
+    if (!icon_widget) return false;
+
+    if (lv_image_get_src(icon_widget) == icon_src)
+    {
+        m_suppressed_updates++;
+        return true;
+    }
+    lv_img_set_src(icon_widget, icon_src);
+    return true;
+}
@@ -1,4 +1,6 @@
 #include <screenLayout.hpp>
+#include <graphics.hpp>
+#include <string.h>
 #include <esp_log.h>
 #include <esp_lvgl_port.h>
 #include <icons.h>
@@ -203,7 +205,14 @@ void ScreenLayout::set_header_text(const char *text)
 
     if (lvgl_port_lock(0))
     {
-        lv_label_set_text(header_label, text);
+        if (strcmp(lv_label_get_text(header_label), text) != 0)
+        {
+            lv_label_set_text(header_label, text);
+        }
+        else
+        {
+            Graphics::get_instance().count_suppressed_update();
+        }
         lvgl_port_unlock();
     }
 }
@@ -219,7 +228,14 @@ void ScreenLayout::set_footer_text(const char *text)
 
     if (lvgl_port_lock(0))
     {
-        lv_label_set_text(footer_label, text);
+        if (strcmp(lv_label_get_text(footer_label), text) != 0)
+        {
+            lv_label_set_text(footer_label, text);
+        }
+        else
+        {
+            Graphics::get_instance().count_suppressed_update();
+        }
         lvgl_port_unlock();
     }
 }
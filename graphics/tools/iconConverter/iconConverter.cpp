@@ -0,0 +1,323 @@
+// Host side icon converter, turns a binary PPM (P6) icon into an LVGL 9 image descriptor source file.
+// Build with: g++ -O2 -std=c++17 iconConverter.cpp -o iconConverter
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+typedef enum {
+    FormatA1,
+    FormatA4,
+    FormatI1
+} format_t;
+
+typedef struct {
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+} rgb_t;
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-f a1 | a4 | i1] [-l] -o icon_16.c icon_16.ppm\n", program);
+    fprintf(stderr, "  -f  format, a1 by default\n");
+    fprintf(stderr, "  -l  the glyph is light on a dark background, dark on a light one by default\n");
+}
+
+static bool read_token(FILE *file, std::string &token)
+{
+    token.clear();
+    int c = fgetc(file);
+    while (c != EOF)
+    {
+        if (c == '#')
+        {
+            while (c != EOF && c != '\n')
+            {
+                c = fgetc(file);
+            }
+        }
+        else if (isspace(c))
+        {
+            if (!token.empty())
+            {
+                return true;
+            }
+        }
+        else
+        {
+            token.push_back(static_cast<char>(c));
+        }
+        c = fgetc(file);
+    }
+    return !token.empty();
+}
+
+static bool read_ppm(const char *path, uint16_t &width, uint16_t &height, std::vector<rgb_t> &pixels)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    std::string magic, width_token, height_token, max_token;
+    if (!read_token(file, magic) || magic != "P6" || !read_token(file, width_token) || !read_token(file, height_token) || !read_token(file, max_token))
+    {
+        fprintf(stderr, "%s: not a binary PPM\n", path);
+        fclose(file);
+        return false;
+    }
+    if (atoi(max_token.c_str()) != 255)
+    {
+        fprintf(stderr, "%s: only 8 bit channels are supported\n", path);
+        fclose(file);
+        return false;
+    }
+
+    width = static_cast<uint16_t>(atoi(width_token.c_str()));
+    height = static_cast<uint16_t>(atoi(height_token.c_str()));
+    pixels.resize(width * height);
+    bool complete = fread(pixels.data(), sizeof(rgb_t), pixels.size(), file) == pixels.size();
+    fclose(file);
+    if (!complete || width == 0 || height == 0)
+    {
+        fprintf(stderr, "%s: truncated\n", path);
+        return false;
+    }
+    return true;
+}
+
+// How much of the pixel the glyph covers, 0 to 255
+static uint8_t coverage(const rgb_t &pixel, bool light_glyph)
+{
+    uint8_t luma = static_cast<uint8_t>((pixel.red * 77 + pixel.green * 150 + pixel.blue * 29) >> 8);
+    return light_glyph ? luma : 255 - luma;
+}
+
+// Rows are packed MSB first, each starting on a byte, which is the stride LVGL computes for these formats
+static std::vector<uint8_t> pack(const std::vector<rgb_t> &pixels, uint16_t width, uint16_t height, format_t format, bool light_glyph, uint32_t &stride)
+{
+    const uint8_t bits = format == FormatA4 ? 4 : 1;
+    stride = (width * bits + 7) / 8;
+
+    std::vector<uint8_t> data;
+    if (format == FormatI1)
+    {
+        // Index 0 is the background, index 1 the glyph, as lv_color32_t (blue, green, red, alpha)
+        rgb_t background = light_glyph ? rgb_t{0x00, 0x00, 0x00} : rgb_t{0xFF, 0xFF, 0xFF};
+        rgb_t glyph = light_glyph ? rgb_t{0xFF, 0xFF, 0xFF} : rgb_t{0x00, 0x00, 0x00};
+        for (const rgb_t &pixel : pixels)
+        {
+            if (coverage(pixel, light_glyph) >= 128)
+            {
+                glyph = pixel;
+                break;
+            }
+        }
+        for (const rgb_t &pixel : pixels)
+        {
+            if (coverage(pixel, light_glyph) < 128)
+            {
+                background = pixel;
+                break;
+            }
+        }
+        for (const rgb_t &color : {background, glyph})
+        {
+            data.push_back(color.blue);
+            data.push_back(color.green);
+            data.push_back(color.red);
+            data.push_back(0xFF);
+        }
+    }
+
+    const size_t offset = data.size();
+    data.resize(offset + stride * height, 0);
+    for (uint16_t y = 0; y < height; y++)
+    {
+        uint8_t *row = data.data() + offset + y * stride;
+        for (uint16_t x = 0; x < width; x++)
+        {
+            const uint8_t value = coverage(pixels[y * width + x], light_glyph);
+            if (format == FormatA4)
+            {
+                row[x / 2] |= static_cast<uint8_t>((value >> 4) << (x % 2 ? 0 : 4));
+            }
+            else if (value >= 128)
+            {
+                row[x / 8] |= static_cast<uint8_t>(0x80 >> (x % 8));
+            }
+        }
+    }
+    return data;
+}
+
+static bool write_source(const char *path, const std::string &name, uint16_t width, uint16_t height, format_t format, uint32_t stride, const std::vector<uint8_t> &data)
+{
+    FILE *file = fopen(path, "w");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "%s: cannot create\n", path);
+        return false;
+    }
+
+    std::string attribute = "LV_ATTRIBUTE_IMAGE_";
+    for (char c : name)
+    {
+        attribute.push_back(static_cast<char>(toupper(static_cast<unsigned char>(c))));
+    }
+    const char *color_format = format == FormatA1 ? "LV_COLOR_FORMAT_A1" : format == FormatA4 ? "LV_COLOR_FORMAT_A4" : "LV_COLOR_FORMAT_I1";
+
+    fprintf(file,
+        "#ifdef __has_include\n"
+        "    #if __has_include(\"lvgl.h\")\n"
+        "        #ifndef LV_LVGL_H_INCLUDE_SIMPLE\n"
+        "            #define LV_LVGL_H_INCLUDE_SIMPLE\n"
+        "        #endif\n"
+        "    #endif\n"
+        "#endif\n"
+        "\n"
+        "#if defined(LV_LVGL_H_INCLUDE_SIMPLE)\n"
+        "    #include \"lvgl.h\"\n"
+        "#else\n"
+        "    #include \"lvgl/lvgl.h\"\n"
+        "#endif\n"
+        "\n"
+        "#ifndef LV_ATTRIBUTE_MEM_ALIGN\n"
+        "#define LV_ATTRIBUTE_MEM_ALIGN\n"
+        "#endif\n"
+        "\n"
+        "#ifndef %s\n"
+        "#define %s\n"
+        "#endif\n"
+        "\n"
+        "const LV_ATTRIBUTE_MEM_ALIGN LV_ATTRIBUTE_LARGE_CONST %s uint8_t %s_map[] = {\n",
+        attribute.c_str(), attribute.c_str(), attribute.c_str(), name.c_str());
+
+    // The palette on its own line, then one line per row of pixels
+    size_t index = 0;
+    const size_t palette_size = format == FormatI1 ? 8 : 0;
+    while (index < data.size())
+    {
+        const size_t line_end = index < palette_size ? palette_size : index + stride;
+        fprintf(file, "    ");
+        for (; index < line_end; index++)
+        {
+            fprintf(file, "0x%02x%s", data[index], index + 1 < data.size() ? (index + 1 < line_end ? ", " : ",") : "");
+        }
+        fprintf(file, "\n");
+    }
+
+    fprintf(file,
+        "};\n"
+        "\n"
+        "const lv_image_dsc_t %s = {\n"
+        "    .header.cf = %s,\n"
+        "    .header.magic = LV_IMAGE_HEADER_MAGIC,\n"
+        "    .header.w = %u,\n"
+        "    .header.h = %u,\n"
+        "    .header.stride = %u,\n"
+        "    .data_size = %zu,\n"
+        "    .data = %s_map,\n"
+        "};\n",
+        name.c_str(), color_format, width, height, stride, data.size(), name.c_str());
+
+    bool written = ferror(file) == 0;
+    written = fclose(file) == 0 && written;
+    if (!written)
+    {
+        fprintf(stderr, "%s: write failed\n", path);
+    }
+    return written;
+}
+
+int main(int argc, char **argv)
+{
+    format_t format = FormatA1;
+    bool light_glyph = false;
+    const char *output = nullptr;
+    const char *input = nullptr;
+
+    for (int index = 1; index < argc; index++)
+    {
+        if (strcmp(argv[index], "-f") == 0 && index + 1 < argc)
+        {
+            const char *name = argv[++index];
+            if (strcmp(name, "a1") == 0)
+            {
+                format = FormatA1;
+            }
+            else if (strcmp(name, "a4") == 0)
+            {
+                format = FormatA4;
+            }
+            else if (strcmp(name, "i1") == 0)
+            {
+                format = FormatI1;
+            }
+            else
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[index], "-l") == 0)
+        {
+            light_glyph = true;
+        }
+        else if (strcmp(argv[index], "-o") == 0 && index + 1 < argc)
+        {
+            output = argv[++index];
+        }
+        else if (argv[index][0] != '-' && input == nullptr)
+        {
+            input = argv[index];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (output == nullptr || input == nullptr)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // The descriptor is named after the output file, icon_16.c holding icon_16
+    std::string name = output;
+    size_t slash = name.find_last_of("/\\");
+    if (slash != std::string::npos)
+    {
+        name = name.substr(slash + 1);
+    }
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos)
+    {
+        name = name.substr(0, dot);
+    }
+
+    uint16_t width = 0;
+    uint16_t height = 0;
+    std::vector<rgb_t> pixels;
+    if (!read_ppm(input, width, height, pixels))
+    {
+        return 1;
+    }
+
+    uint32_t stride = 0;
+    std::vector<uint8_t> data = pack(pixels, width, height, format, light_glyph, stride);
+    if (!write_source(output, name, width, height, format, stride, data))
+    {
+        return 1;
+    }
+
+    printf("%s: %ux%u, %zu bytes instead of %u as RGB565\n", output, width, height, data.size(), width * height * 2);
+    return 0;
+}
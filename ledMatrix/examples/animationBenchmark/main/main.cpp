@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include <animationEncoder.hpp>
+
+#define FRAME_NB 60
+#define ITERATIONS 20
+
+typedef std::vector<std::vector<uint16_t>> frames_t;
+
+static uint16_t rgb565(uint8_t red, uint8_t green, uint8_t blue)
+{
+    return static_cast<uint16_t>(((red & 0xF8) << 8) | ((green & 0xFC) << 3) | (blue >> 3));
+}
+
+// Full screen motion, every pixel changes on every frame
+static frames_t scrolling_gradient(uint16_t width, uint16_t height)
+{
+    frames_t frames(FRAME_NB, std::vector<uint16_t>(width * height));
+    for (int frame = 0; frame < FRAME_NB; frame++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                frames[frame][y * width + x] = rgb565((x + frame) * 4, y * 8, (x + y + frame) * 2);
+            }
+        }
+    }
+    return frames;
+}
+
+// 8x8 sprite bouncing over a still background made of flat color bands
+static frames_t bouncing_sprite(uint16_t width, uint16_t height)
+{
+    frames_t frames(FRAME_NB, std::vector<uint16_t>(width * height));
+    int sprite_x = 0, sprite_y = 0, step_x = 3, step_y = 2;
+    for (int frame = 0; frame < FRAME_NB; frame++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                frames[frame][y * width + x] = rgb565(0, 0, (y / 8) * 32);
+            }
+        }
+        for (int y = 0; y < 8; y++)
+        {
+            for (int x = 0; x < 8; x++)
+            {
+                frames[frame][(sprite_y + y) * width + sprite_x + x] = rgb565(255, x * 32, y * 32);
+            }
+        }
+        if (sprite_x + step_x < 0 || sprite_x + step_x > width - 8)
+        {
+            step_x = -step_x;
+        }
+        if (sprite_y + step_y < 0 || sprite_y + step_y > height - 8)
+        {
+            step_y = -step_y;
+        }
+        sprite_x += step_x;
+        sprite_y += step_y;
+    }
+    return frames;
+}
+
+// Worst case, nothing to skip nor to run
+static frames_t noise(uint16_t width, uint16_t height)
+{
+    frames_t frames(FRAME_NB, std::vector<uint16_t>(width * height));
+    for (auto &frame : frames)
+    {
+        for (auto &pixel : frame)
+        {
+            pixel = static_cast<uint16_t>(rand());
+        }
+    }
+    return frames;
+}
+
+static void benchmark(const char *name, uint16_t width, uint16_t height, const frames_t &frames)
+{
+    using namespace macdap::animation;
+
+    const size_t pixel_nb = static_cast<size_t>(width) * height;
+    std::vector<uint8_t> animation = encode(frames, width, height, 50);
+    size_t raw_size = frames.size() * pixel_nb * sizeof(uint16_t);
+
+    bool valid = validate(animation.data(), animation.size());
+    std::vector<uint16_t> canvas(pixel_nb);
+    bool match = valid;
+    uint64_t total_ns = 0;
+
+    for (int iteration = 0; iteration < ITERATIONS && valid; iteration++)
+    {
+        std::fill(canvas.begin(), canvas.end(), 0);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t frame = 0; frame < frames.size(); frame++)
+        {
+            uint32_t offset = read_offset(animation.data(), frame);
+            changed_span_t changed;
+            if (!decode_frame(animation.data() + offset, read_offset(animation.data(), frame + 1) - offset, canvas.data(), pixel_nb, &changed))
+            {
+                match = false;
+                break;
+            }
+            if (iteration == 0 && canvas != frames[frame])
+            {
+                match = false;
+            }
+        }
+        total_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double frame_us = total_ns / 1000.0 / (ITERATIONS * frames.size());
+    double mpixels = total_ns > 0 ? 1000.0 * ITERATIONS * frames.size() * pixel_nb / total_ns : 0;
+    printf("%-8s %3ux%-3u %7zu bytes, %5.1f%% of raw, decode %8.2f us/frame, %7.1f Mpx/s, %s\n", name, width, height,
+           animation.size(), 100.0 * animation.size() / raw_size, frame_us, mpixels,
+           match ? "match" : "MISMATCH");
+}
+
+extern "C" void app_main(void)
+{
+    const uint16_t resolutions[][2] = {{64, 32}, {128, 64}};
+
+    for (const auto &resolution : resolutions)
+    {
+        benchmark("gradient", resolution[0], resolution[1], scrolling_gradient(resolution[0], resolution[1]));
+        benchmark("sprite", resolution[0], resolution[1], bouncing_sprite(resolution[0], resolution[1]));
+        benchmark("noise", resolution[0], resolution[1], noise(resolution[0], resolution[1]));
+    }
+}
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <esp_freertos_hooks.h>
+#include <driver/pulse_cnt.h>
+#include <ledMatrix.hpp>
+
+static const char *TAG = "characterization";
+
+#define PROBE_HIGH_LIMIT 10000
+
+static const uint32_t _clock_speeds_hz[] = {8000000, 10000000, 16000000, 20000000};
+static const bool _double_buffers[] = {false, true};
+
+static volatile uint32_t _idle_counts[portNUM_PROCESSORS];
+static pcnt_unit_handle_t _probe_unit = nullptr;
+
+// Keeps the idle task spinning instead of waiting for an interrupt, so that its count follows the idle time
+static bool idle_hook_0()
+{
+    _idle_counts[0]++;
+    return false;
+}
+
+#if portNUM_PROCESSORS > 1
+static bool idle_hook_1()
+{
+    _idle_counts[1]++;
+    return false;
+}
+#endif
+
+static void start_probe()
+{
+    if (CONFIG_CHARACTERIZATION_PROBE_GPIO < 0)
+    {
+        return;
+    }
+
+    pcnt_unit_config_t unit_config = {};
+    unit_config.low_limit = -1;
+    unit_config.high_limit = PROBE_HIGH_LIMIT;
+    unit_config.flags.accum_count = 1;
+    ESP_ERROR_CHECK(pcnt_new_unit(&unit_config, &_probe_unit));
+
+    pcnt_chan_config_t channel_config = {};
+    channel_config.edge_gpio_num = CONFIG_CHARACTERIZATION_PROBE_GPIO;
+    channel_config.level_gpio_num = -1;
+    pcnt_channel_handle_t channel;
+    ESP_ERROR_CHECK(pcnt_new_channel(_probe_unit, &channel_config, &channel));
+    ESP_ERROR_CHECK(pcnt_channel_set_edge_action(channel, PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_HOLD));
+    ESP_ERROR_CHECK(pcnt_unit_add_watch_point(_probe_unit, PROBE_HIGH_LIMIT));
+    ESP_ERROR_CHECK(pcnt_unit_enable(_probe_unit));
+    ESP_ERROR_CHECK(pcnt_unit_start(_probe_unit));
+}
+
+typedef struct {
+    uint32_t idle_counts[portNUM_PROCESSORS];
+    float refresh_hz;
+} window_t;
+
+// Counts idle loops and probe edges over the measurement window
+static window_t measure_window()
+{
+    window_t window = {};
+    uint32_t start_counts[portNUM_PROCESSORS];
+
+    if (_probe_unit != nullptr)
+    {
+        pcnt_unit_clear_count(_probe_unit);
+    }
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        start_counts[core] = _idle_counts[core];
+    }
+    int64_t start_us = esp_timer_get_time();
+
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_CHARACTERIZATION_WINDOW_MS));
+
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        window.idle_counts[core] = _idle_counts[core] - start_counts[core];
+    }
+    if (_probe_unit != nullptr)
+    {
+        int edges = 0;
+        pcnt_unit_get_count(_probe_unit, &edges);
+        window.refresh_hz = edges * 1000000.0f / elapsed_us / CONFIG_CHARACTERIZATION_PROBE_EDGES_PER_REFRESH;
+    }
+    return window;
+}
+
+// Full frame gradient, drawn and presented through the direct path, returns the time taken
+static int64_t draw_test_frame(macdap::LedMatrix &ledMatrix, int32_t width, int32_t height, uint16_t *frame)
+{
+    for (int32_t y = 0; y < height; y++)
+    {
+        for (int32_t x = 0; x < width; x++)
+        {
+            uint8_t red = x * 255 / width;
+            uint8_t green = y * 255 / height;
+            uint8_t blue = 255 - red;
+            frame[y * width + x] = ((red & 0xF8) << 8) | ((green & 0xFC) << 3) | (blue >> 3);
+        }
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    ledMatrix.blit(0, 0, width, height, frame);
+    ledMatrix.present();
+    if (ledMatrix.is_double_buffered())
+    {
+        // Both buffers hold the test frame
+        ledMatrix.blit(0, 0, width, height, frame);
+        ledMatrix.present();
+    }
+    return esp_timer_get_time() - start_us;
+}
+
+extern "C" void app_main(void)
+{
+    ESP_LOGI(TAG, "LED Matrix Characterization Program");
+
+    const lvgl_port_cfg_t lvgl_config = ESP_LVGL_PORT_INIT_CONFIG();
+    lvgl_port_init(&lvgl_config);
+
+    ESP_ERROR_CHECK(esp_register_freertos_idle_hook_for_cpu(idle_hook_0, 0));
+#if portNUM_PROCESSORS > 1
+    ESP_ERROR_CHECK(esp_register_freertos_idle_hook_for_cpu(idle_hook_1, 1));
+#endif
+    start_probe();
+
+    // Idle counts without the driver, the reference for the CPU load
+    window_t baseline = measure_window();
+
+    macdap::LedMatrix &ledMatrix = macdap::LedMatrix::get_instance();
+    lv_display_t *lv_display = ledMatrix.get_lv_display();
+    int32_t width = lv_display_get_horizontal_resolution(lv_display);
+    int32_t height = lv_display_get_vertical_resolution(lv_display);
+    ledMatrix.set_direct_mode(true);
+
+    uint16_t *frame = static_cast<uint16_t*>(heap_caps_malloc(width * height * sizeof(uint16_t), MALLOC_CAP_DEFAULT));
+    if (frame == nullptr)
+    {
+        ESP_LOGE(TAG, "Frame allocation failure!");
+        return;
+    }
+
+    macdap::led_matrix_config_t default_config = ledMatrix.get_config();
+
+#if defined(HUB75_BIT_DEPTH)
+    printf("%ldx%ld panel, %d bit depth, %u Hz min refresh, %u latch blanking\n", width, height, HUB75_BIT_DEPTH,
+           default_config.min_refresh_rate, default_config.latch_blanking);
+#elif defined(CONFIG_HUB75_BIT_DEPTH)
+    printf("%ldx%ld panel, %d bit depth, %u Hz min refresh, %u latch blanking\n", width, height, CONFIG_HUB75_BIT_DEPTH,
+           default_config.min_refresh_rate, default_config.latch_blanking);
+#else
+    printf("%ldx%ld panel, driver default bit depth, %u Hz min refresh, %u latch blanking\n", width, height,
+           default_config.min_refresh_rate, default_config.latch_blanking);
+#endif
+    printf("clock MHz, buffers, refresh Hz, DMA bytes, frame us");
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        printf(", core %d load %%", core);
+    }
+    printf("\n");
+
+    for (uint32_t clock_speed_hz : _clock_speeds_hz)
+    {
+        for (bool double_buffer : _double_buffers)
+        {
+            macdap::led_matrix_config_t config = default_config;
+            config.clock_speed_hz = clock_speed_hz;
+            config.double_buffer = double_buffer;
+
+            esp_err_t err = ledMatrix.reconfigure(config);
+            if (err != ESP_OK)
+            {
+                printf("%lu, %d, %s\n", clock_speed_hz / 1000000, double_buffer ? 2 : 1, esp_err_to_name(err));
+                continue;
+            }
+
+            int64_t frame_us = draw_test_frame(ledMatrix, width, height, frame);
+            window_t window = measure_window();
+
+            if (_probe_unit != nullptr)
+            {
+                printf("%lu, %d, %.1f, %zu, %lld", clock_speed_hz / 1000000, double_buffer ? 2 : 1, window.refresh_hz,
+                       ledMatrix.get_driver_memory(), frame_us);
+            }
+            else
+            {
+                printf("%lu, %d, n/a, %zu, %lld", clock_speed_hz / 1000000, double_buffer ? 2 : 1,
+                       ledMatrix.get_driver_memory(), frame_us);
+            }
+            for (int core = 0; core < portNUM_PROCESSORS; core++)
+            {
+                float load = baseline.idle_counts[core] == 0 ? 0 : 100.0f * (1.0f - static_cast<float>(window.idle_counts[core]) / baseline.idle_counts[core]);
+                printf(", %.1f", load < 0 ? 0 : load);
+            }
+            printf("\n");
+        }
+    }
+
+    ledMatrix.reconfigure(default_config);
+    ledMatrix.set_direct_mode(false);
+    heap_caps_free(frame);
+    ESP_LOGI(TAG, "Characterization done");
+}
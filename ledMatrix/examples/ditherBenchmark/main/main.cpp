@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include <ledMatrixDither.hpp>
+
+#define ITERATIONS 200
+
+namespace dither = macdap::dither;
+
+typedef struct {
+    const char *name;
+    uint8_t bits;
+    uint8_t shift;
+} channel_t;
+
+static const channel_t CHANNELS[] = {
+    {"red", 5, 11},
+    {"green", 6, 5},
+    {"blue", 5, 0}
+};
+
+static float target_intensity(uint8_t code, uint8_t bits, bool gamma)
+{
+    float intensity = dither::expand(code, bits) / 255.0f;
+    return gamma ? dither::cie1931(intensity) : intensity;
+}
+
+static uint8_t channel_code(uint16_t pixel, const channel_t &channel)
+{
+    return static_cast<uint8_t>((pixel >> channel.shift) & ((1 << channel.bits) - 1));
+}
+
+// Worst difference between what a channel code should show and what it shows, in driver levels.
+// The ordered dithering averages over a 4x4 tile, the temporal one over 16 frames at a single pixel.
+static void verify_accuracy(uint8_t bit_depth, bool gamma)
+{
+    dither::table_t table;
+    dither::build_table(table, bit_depth, gamma);
+    const float level = bit_depth >= 8 ? 1.0f / 255.0f : 1.0f / ((1 << bit_depth) - 1);
+
+    float truncated_error = 0.0f;
+    float ordered_error = 0.0f;
+    float temporal_error = 0.0f;
+    bool match = true;
+    for (const channel_t &channel : CHANNELS)
+    {
+        const dither::level_t *levels = channel.bits == 5 ? (channel.shift == 11 ? table.red : table.blue) : table.green;
+        for (uint8_t code = 0; code < (1 << channel.bits); code++)
+        {
+            const float target = target_intensity(code, channel.bits, gamma);
+            const float low = dither::physical_intensity(levels[code].low, channel.bits, bit_depth);
+            const float high = dither::physical_intensity(levels[code].high, channel.bits, bit_depth);
+
+            // The two closest physical levels must surround the target
+            match = match && levels[code].low <= levels[code].high && low <= target + 1e-6f && (target <= high + 1e-6f || levels[code].low == levels[code].high);
+            truncated_error = fmaxf(truncated_error, fabsf(target - low) / level);
+
+            const uint16_t pixel = static_cast<uint16_t>(code << channel.shift);
+            uint16_t source[4] = {pixel, pixel, pixel, pixel};
+            uint16_t destination[4];
+
+            float ordered_sum = 0.0f;
+            for (int32_t y = 0; y < 4; y++)
+            {
+                dither::dither_row(source, destination, 4, 0, y, dither::phase(0), table);
+                for (uint16_t output : destination)
+                {
+                    ordered_sum += dither::physical_intensity(channel_code(output, channel), channel.bits, bit_depth);
+                }
+            }
+
+            float temporal_sum = 0.0f;
+            for (uint32_t frame = 0; frame < 16; frame++)
+            {
+                dither::dither_row(source, destination, 1, 5, 3, dither::phase(frame), table);
+                temporal_sum += dither::physical_intensity(channel_code(destination[0], channel), channel.bits, bit_depth);
+            }
+
+            // The 16 thresholds split the step between the two levels in sixteenths, plus the rounding of the fraction
+            const float bound = (high - low) * (1.0f / 16.0f + 1.0f / 255.0f) / level + 1e-4f;
+            const float ordered = fabsf(ordered_sum / 16.0f - target) / level;
+            const float temporal = fabsf(temporal_sum / 16.0f - target) / level;
+            match = match && ordered <= bound && temporal <= bound;
+            ordered_error = fmaxf(ordered_error, ordered);
+            temporal_error = fmaxf(temporal_error, temporal);
+        }
+    }
+    printf("%2u bits %-8s truncated %5.3f  ordered %5.3f  temporal %5.3f levels  %s\n",
+           bit_depth, gamma ? "CIE 1931" : "linear", truncated_error, ordered_error, temporal_error, match ? "match" : "MISMATCH");
+}
+
+// Every pixel must go through all the thresholds over 16 frames
+static void verify_phases()
+{
+    uint16_t seen = 0;
+    for (uint32_t frame = 0; frame < 16; frame++)
+    {
+        seen |= static_cast<uint16_t>(1 << dither::phase(frame));
+    }
+    printf("phases              %s\n", seen == 0xFFFF ? "match" : "MISMATCH");
+}
+
+static void benchmark(int32_t width, int32_t height)
+{
+    dither::table_t table;
+    dither::build_table(table, 6, true);
+
+    std::vector<uint16_t> source(width * height);
+    std::vector<uint16_t> destination(width * height);
+    for (auto &pixel : source)
+    {
+        pixel = static_cast<uint16_t>(rand());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++)
+    {
+        for (int32_t y = 0; y < height; y++)
+        {
+            dither::dither_row(source.data() + y * width, destination.data() + y * width, width, 0, y, dither::phase(iteration), table);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double elapsed_s = std::chrono::duration<double>(end - start).count();
+    printf("%3ldx%-3ld dither_row %8.2f us/frame  %8.2f Mpx/s\n", static_cast<long>(width), static_cast<long>(height),
+           elapsed_s * 1e6 / ITERATIONS, static_cast<double>(width) * height * ITERATIONS / elapsed_s / 1e6);
+}
+
+extern "C" void app_main(void)
+{
+    printf("LED Matrix dithering benchmark, %d iterations\n", ITERATIONS);
+
+    verify_phases();
+    for (uint8_t bit_depth : {4, 5, 6, 7, 8})
+    {
+        verify_accuracy(bit_depth, false);
+        verify_accuracy(bit_depth, true);
+    }
+
+    benchmark(64, 32);
+    benchmark(128, 64);
+    benchmark(256, 128);
+}
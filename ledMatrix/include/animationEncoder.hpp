@@ -0,0 +1,138 @@
+#pragma once
+
+#include <animationFormat.hpp>
+#include <vector>
+
+// Host side encoder of the animation format described in animationFormat.hpp.
+// Used by tools/animationEncoder and by the decode benchmark.
+
+namespace macdap
+{
+    namespace animation
+    {
+        namespace encoding
+        {
+            static inline void put_color(std::vector<uint8_t> &output, uint16_t color)
+            {
+                output.push_back(static_cast<uint8_t>(color));
+                output.push_back(static_cast<uint8_t>(color >> 8));
+            }
+
+            static inline void put_skip(std::vector<uint8_t> &output, size_t count)
+            {
+                while (count > 0)
+                {
+                    if (count > MAX_COUNT)
+                    {
+                        size_t chunk = count < MAX_SKIP_LONG ? count : MAX_SKIP_LONG;
+                        output.push_back(static_cast<uint8_t>(OP_SKIP_LONG | ((chunk - 1) >> 8)));
+                        output.push_back(static_cast<uint8_t>(chunk - 1));
+                        count -= chunk;
+                    }
+                    else
+                    {
+                        output.push_back(static_cast<uint8_t>(OP_SKIP | (count - 1)));
+                        count = 0;
+                    }
+                }
+            }
+
+            // Runs of at least this many equal pixels are cheaper as RUN than as part of a COPY
+            static constexpr size_t MIN_RUN = 3;
+        }
+
+        // Appends the ops turning previous into current, both pixel_nb RGB565 pixels
+        static inline void encode_frame(const uint16_t *previous, const uint16_t *current, size_t pixel_nb, std::vector<uint8_t> &output)
+        {
+            using namespace encoding;
+
+            size_t pixel = 0;
+            while (pixel < pixel_nb)
+            {
+                size_t skip = 0;
+                while (pixel + skip < pixel_nb && current[pixel + skip] == previous[pixel + skip])
+                {
+                    skip++;
+                }
+                if (pixel + skip == pixel_nb)
+                {
+                    // Trailing unchanged pixels need no op
+                    break;
+                }
+                put_skip(output, skip);
+                pixel += skip;
+
+                // Changed pixels up to the next unchanged stretch, as RUNs and COPYs
+                size_t copy_start = pixel;
+                while (pixel < pixel_nb && (current[pixel] != previous[pixel] || (pixel + 1 < pixel_nb && current[pixel + 1] != previous[pixel + 1])))
+                {
+                    size_t run = 1;
+                    while (pixel + run < pixel_nb && run < MAX_COUNT && current[pixel + run] == current[pixel])
+                    {
+                        run++;
+                    }
+                    if (run >= MIN_RUN)
+                    {
+                        for (size_t start = copy_start; start < pixel; start += MAX_COUNT)
+                        {
+                            size_t count = pixel - start < MAX_COUNT ? pixel - start : MAX_COUNT;
+                            output.push_back(static_cast<uint8_t>(OP_COPY | (count - 1)));
+                            for (size_t index = 0; index < count; index++)
+                            {
+                                put_color(output, current[start + index]);
+                            }
+                        }
+                        output.push_back(static_cast<uint8_t>(OP_RUN | (run - 1)));
+                        put_color(output, current[pixel]);
+                        pixel += run;
+                        copy_start = pixel;
+                    }
+                    else
+                    {
+                        pixel++;
+                    }
+                }
+                for (size_t start = copy_start; start < pixel; start += MAX_COUNT)
+                {
+                    size_t count = pixel - start < MAX_COUNT ? pixel - start : MAX_COUNT;
+                    output.push_back(static_cast<uint8_t>(OP_COPY | (count - 1)));
+                    for (size_t index = 0; index < count; index++)
+                    {
+                        put_color(output, current[start + index]);
+                    }
+                }
+            }
+        }
+
+        // Encodes frames of width x height RGB565 pixels into a complete animation
+        static inline std::vector<uint8_t> encode(const std::vector<std::vector<uint16_t>> &frames, uint16_t width, uint16_t height, uint16_t frame_period_ms)
+        {
+            const size_t pixel_nb = static_cast<size_t>(width) * height;
+            animation_header_t header = {};
+            memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.width = width;
+            header.height = height;
+            header.frame_count = static_cast<uint16_t>(frames.size());
+            header.frame_period_ms = frame_period_ms;
+
+            std::vector<uint8_t> data;
+            std::vector<uint32_t> offsets;
+            const uint32_t table_end = sizeof(animation_header_t) + (frames.size() + 1) * sizeof(uint32_t);
+            std::vector<uint16_t> black(pixel_nb, 0);
+            const uint16_t *previous = black.data();
+            for (const auto &frame : frames)
+            {
+                offsets.push_back(table_end + data.size());
+                encode_frame(previous, frame.data(), pixel_nb, data);
+                previous = frame.data();
+            }
+            offsets.push_back(table_end + data.size());
+
+            std::vector<uint8_t> animation(table_end);
+            memcpy(animation.data(), &header, sizeof(header));
+            memcpy(animation.data() + sizeof(header), offsets.data(), offsets.size() * sizeof(uint32_t));
+            animation.insert(animation.end(), data.begin(), data.end());
+            return animation;
+        }
+    }
+}
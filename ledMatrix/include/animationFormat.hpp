@@ -0,0 +1,163 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Pre-encoded LED matrix animation, as produced by tools/animationEncoder.
+// Shared with the host encoder, so plain C++ only.
+//
+// An animation is an animation_header_t, then (frame_count + 1) uint32_t offsets from the start of the animation,
+// frame n being the bytes from offset n to offset n + 1. All values are little endian.
+// A frame is a list of ops over the width x height RGB565 pixels in row order, applied to the previous frame
+// (to a black frame for frame 0). Each op starts with a byte, the 2 high bits being the op and the 6 low bits
+// a count minus one:
+//   SKIP       count pixels left unchanged
+//   RUN        count pixels set to the RGB565 color that follows
+//   COPY       count RGB565 colors follow, one per pixel
+//   SKIP_LONG  ((count - 1) << 8 | next byte) + 1 pixels left unchanged, up to 16384
+
+namespace macdap
+{
+    namespace animation
+    {
+        static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Colors are copied as is, which assumes a little endian target");
+
+        static constexpr char MAGIC[4] = {'L', 'M', 'A', '1'};
+
+        static constexpr uint8_t OP_SKIP = 0x00;
+        static constexpr uint8_t OP_RUN = 0x40;
+        static constexpr uint8_t OP_COPY = 0x80;
+        static constexpr uint8_t OP_SKIP_LONG = 0xC0;
+        static constexpr uint8_t OP_MASK = 0xC0;
+        static constexpr uint32_t MAX_COUNT = 64;
+        static constexpr uint32_t MAX_SKIP_LONG = 64 * 256;
+
+        typedef struct __attribute__((packed)) {
+            char magic[4];
+            uint16_t width;
+            uint16_t height;
+            uint16_t frame_count;
+            uint16_t frame_period_ms;
+            uint32_t reserved;
+        } animation_header_t;
+
+        static_assert(sizeof(animation_header_t) == 16, "animation_header_t is part of the file format");
+
+        // Pixels first..last (inclusive) hold every pixel a frame changed, first > last when none changed
+        typedef struct {
+            size_t first;
+            size_t last;
+        } changed_span_t;
+
+        static inline uint32_t read_offset(const uint8_t *animation, uint32_t frame)
+        {
+            uint32_t offset;
+            memcpy(&offset, animation + sizeof(animation_header_t) + frame * sizeof(uint32_t), sizeof(offset));
+            return offset;
+        }
+
+        // Checks the header and the offset table of an animation of size bytes
+        static inline bool validate(const uint8_t *animation, size_t size)
+        {
+            if (size < sizeof(animation_header_t))
+            {
+                return false;
+            }
+            animation_header_t header;
+            memcpy(&header, animation, sizeof(header));
+            if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.width == 0 || header.height == 0 || header.frame_count == 0)
+            {
+                return false;
+            }
+            size_t table_end = sizeof(animation_header_t) + (header.frame_count + 1) * sizeof(uint32_t);
+            if (table_end > size)
+            {
+                return false;
+            }
+            uint32_t previous = table_end;
+            for (uint32_t frame = 0; frame <= header.frame_count; frame++)
+            {
+                uint32_t offset = read_offset(animation, frame);
+                if (offset < previous || offset > size)
+                {
+                    return false;
+                }
+                previous = offset;
+            }
+            return true;
+        }
+
+        // Applies a frame to canvas, which holds the previous frame.
+        // Returns false if the frame is malformed, canvas then holding a partially decoded frame.
+        static inline bool decode_frame(const uint8_t *frame, size_t frame_size, uint16_t *canvas, size_t pixel_nb, changed_span_t *changed)
+        {
+            const uint8_t *end = frame + frame_size;
+            size_t pixel = 0;
+            changed->first = pixel_nb;
+            changed->last = 0;
+
+            while (frame < end)
+            {
+                const uint8_t op = *frame & OP_MASK;
+                uint32_t count = (*frame & ~OP_MASK) + 1;
+                frame++;
+
+                if (op == OP_SKIP_LONG)
+                {
+                    if (frame >= end)
+                    {
+                        return false;
+                    }
+                    count = (((count - 1) << 8) | *frame) + 1;
+                    frame++;
+                }
+                if (count > pixel_nb - pixel)
+                {
+                    return false;
+                }
+
+                if (op == OP_RUN || op == OP_COPY)
+                {
+                    if (pixel < changed->first)
+                    {
+                        changed->first = pixel;
+                    }
+                    changed->last = pixel + count - 1;
+                }
+
+                switch (op)
+                {
+                    case OP_RUN:
+                    {
+                        if (end - frame < 2)
+                        {
+                            return false;
+                        }
+                        uint16_t color;
+                        memcpy(&color, frame, sizeof(color));
+                        frame += sizeof(color);
+                        uint16_t *destination = canvas + pixel;
+                        for (uint32_t index = 0; index < count; index++)
+                        {
+                            destination[index] = color;
+                        }
+                        break;
+                    }
+                    case OP_COPY:
+                        if (static_cast<size_t>(end - frame) < count * sizeof(uint16_t))
+                        {
+                            return false;
+                        }
+                        memcpy(canvas + pixel, frame, count * sizeof(uint16_t));
+                        frame += count * sizeof(uint16_t);
+                        break;
+                    default:
+                        break;
+                }
+                pixel += count;
+            }
+            return true;
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <ledMatrix.hpp>
+#include <animationFormat.hpp>
+#include <esp_partition.h>
+
+namespace macdap
+{
+    // Plays a pre-encoded animation (see animationFormat.hpp) memory mapped from a data partition.
+    // Frames are decoded into an internal RAM canvas and the changed rows are blitted in LedMatrix direct mode,
+    // LVGL getting the panel back once the animation stops.
+    class AnimationPlayer
+    {
+
+    private:
+        LedMatrix &m_ledMatrix;
+        esp_partition_mmap_handle_t m_mmap_handle;
+        const uint8_t *m_animation;
+        size_t m_animation_size;
+        animation::animation_header_t m_header;
+        uint16_t *m_canvas;
+        TaskHandle_t m_task_handle;
+        SemaphoreHandle_t m_done_semaphore;
+        volatile bool m_stop;
+        volatile bool m_playing;
+        bool m_loop;
+        static void play_task(void *arg);
+        void close();
+
+    public:
+        AnimationPlayer(LedMatrix &ledMatrix);
+        ~AnimationPlayer();
+        AnimationPlayer(AnimationPlayer const&) = delete;
+        void operator=(AnimationPlayer const &) = delete;
+        esp_err_t open(const char *partition_label);
+        esp_err_t play(bool loop);
+        void stop();
+        bool is_playing() const { return m_playing; }
+        uint16_t get_frame_count() const { return m_header.frame_count; }
+        uint16_t get_frame_period_ms() const { return m_header.frame_period_ms; }
+    };
+}
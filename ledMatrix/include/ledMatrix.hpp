@@ -2,18 +2,78 @@
 
 #include <lvgl.h>
 #include <esp_lvgl_port.h>
+#include <esp_timer.h>
+#include <hub75.h>
 
 namespace macdap
 {
+    typedef struct {
+        uint32_t flush_count;
+        uint32_t frame_count;           // A frame being one or more flushes
+        uint64_t pixels_converted;
+        uint64_t bytes_transmitted;     // Handed to the HUB75 driver, which refreshes the panel on its own
+        uint32_t flush_min_us;
+        uint32_t flush_avg_us;
+        uint32_t flush_max_us;
+        uint64_t bus_wait_us;           // Blocked on the driver, held by blit(), the dither task and reconfigure(), or on a buffer flip
+        float fps;
+    } led_matrix_stats_t;
+
+    // Driver settings that can change at runtime, initialized from the Hub75Config the matrix is built with
+    typedef struct {
+        uint32_t clock_speed_hz;        // 8, 10, 16 or 20 MHz, rounded down to one of these
+        uint16_t min_refresh_rate;
+        uint8_t latch_blanking;
+        uint8_t brightness;
+        bool double_buffer;
+    } led_matrix_config_t;
+
     class LedMatrix
     {
 
     private:
         lv_display_t *m_display;
+        uint8_t *m_lv_buffer;
+        uint8_t *m_lv_buffer_2;
+        const uint8_t *m_last_frame;    // Last full frame flushed by LVGL
+        Hub75Driver *m_driver;
+        SemaphoreHandle_t m_driver_mutex;
+        Hub75Config m_driver_config;
+        led_matrix_config_t m_config;
+        size_t m_driver_memory;
+        volatile bool m_direct_mode;
+        int32_t m_horizontal_resolution;
+        int32_t m_vertical_resolution;
+        SemaphoreHandle_t m_stats_mutex;
+        led_matrix_stats_t m_stats;
+        uint64_t m_flush_total_us;
+        int64_t m_stats_start_us;
+        esp_timer_handle_t m_stats_timer;
+#ifdef CONFIG_LED_MATRIX_DITHERING
+        uint16_t *m_dither_stripe;
+        uint32_t m_dither_frame;
+        void dither_pixels(int32_t x, int32_t y, int32_t width, int32_t height, const uint16_t *pixels, int32_t stride);
+#endif
+#ifdef CONFIG_LED_MATRIX_DITHER_TEMPORAL
+        uint16_t *m_dither_source;
+        TaskHandle_t m_dither_task_handle;
+        static void dither_task(void *arg);
+#endif
+#ifdef CONFIG_LED_MATRIX_PIPELINED_FLUSH
+        volatile bool m_flush_pending;
+        static void flush_task(void *arg);
+        static bool start_flush_workers();
+#endif
         LedMatrix();
-        ~LedMatrix();
+        esp_err_t start_driver(const Hub75Config &driver_config);
+        void draw_pixels(int32_t x, int32_t y, int32_t width, int32_t height, const uint16_t *pixels, int32_t stride);
+        void draw_area(const lv_area_t *area, uint8_t *px_map, bool last);
+        static void flush_cb(lv_display_t *display, const lv_area_t *area, uint8_t *px_map);
+        static void stats_timer_callback(void *arg);
 
     public:
+        LedMatrix(const Hub75Config &config);
+        ~LedMatrix();
         LedMatrix(LedMatrix const&) = delete;
         void operator=(LedMatrix const &) = delete;
         static LedMatrix &get_instance()
@@ -21,8 +81,20 @@ namespace macdap
             static LedMatrix instance;
             return instance;
         }
+        static Hub75Config get_default_driver_config();
         lv_display_t *get_lv_display();
         void set_brightness(uint8_t brightness);
         void set_intensity(float intensity);
+        led_matrix_config_t get_config();
+        esp_err_t reconfigure(const led_matrix_config_t &config);
+        size_t get_driver_memory();
+        bool is_double_buffered() { return get_config().double_buffer; }
+        void set_direct_mode(bool enabled);
+        bool is_direct_mode() const { return m_direct_mode; }
+        esp_err_t blit(int32_t x, int32_t y, int32_t width, int32_t height, const uint16_t *pixels);
+        void present();
+        led_matrix_stats_t get_stats();
+        void reset_stats();
+        esp_err_t get_snapshot(uint8_t *buffer, size_t size, size_t *length);
     };
 }
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+
+// Ordered and temporal dithering of RGB565 pixels ahead of a lower bit depth HUB75 driver.
+// The gamma is applied here rather than by the driver, which has to be linear, so that the dark levels that the
+// gamma squeezes together are spread between the two closest physical levels instead of being truncated.
+// Checked against the target intensities on the host by examples/ditherBenchmark.
+
+namespace macdap
+{
+    namespace dither
+    {
+        // Codes to output for one RGB565 channel code, the high one when fraction is above the threshold
+        typedef struct {
+            uint8_t low;
+            uint8_t high;
+            uint8_t fraction;
+        } level_t;
+
+        typedef struct {
+            level_t red[32];
+            level_t green[64];
+            level_t blue[32];
+        } table_t;
+
+        // 4x4 Bayer matrix
+        static constexpr uint8_t THRESHOLDS[16] = {
+            0, 8, 2, 10,
+            12, 4, 14, 6,
+            3, 11, 1, 9,
+            15, 7, 13, 5
+        };
+
+        static inline uint8_t expand(uint8_t code, uint8_t bits)
+        {
+            return bits == 5 ? static_cast<uint8_t>((code << 3) | (code >> 2)) : static_cast<uint8_t>((code << 2) | (code >> 4));
+        }
+
+        // Light output of a channel code, a linear driver showing the bit_depth MSB of the code expanded to 8 bits
+        static inline float physical_intensity(uint8_t code, uint8_t bits, uint8_t bit_depth)
+        {
+            if (bit_depth >= 8)
+            {
+                return expand(code, bits) / 255.0f;
+            }
+            return (expand(code, bits) >> (8 - bit_depth)) / static_cast<float>((1 << bit_depth) - 1);
+        }
+
+        // CIE 1931 lightness to luminance
+        static inline float cie1931(float lightness)
+        {
+            lightness *= 100.0f;
+            return lightness <= 8.0f ? lightness / 903.3f : powf((lightness + 16.0f) / 116.0f, 3.0f);
+        }
+
+        static inline void build_channel(level_t *levels, uint8_t bits, uint8_t bit_depth, bool gamma)
+        {
+            const uint8_t code_nb = 1 << bits;
+            for (uint8_t code = 0; code < code_nb; code++)
+            {
+                float intensity = expand(code, bits) / 255.0f;
+                float target = gamma ? cie1931(intensity) : intensity;
+
+                // Highest code lit no more than the target, then the first code of the next physical level
+                uint8_t low = 0;
+                while (low + 1 < code_nb && physical_intensity(low + 1, bits, bit_depth) <= target)
+                {
+                    low++;
+                }
+                uint8_t high = low;
+                while (high + 1 < code_nb && physical_intensity(high, bits, bit_depth) <= physical_intensity(low, bits, bit_depth))
+                {
+                    high++;
+                }
+
+                float low_intensity = physical_intensity(low, bits, bit_depth);
+                float high_intensity = physical_intensity(high, bits, bit_depth);
+                float fraction = high_intensity > low_intensity ? (target - low_intensity) / (high_intensity - low_intensity) : 0.0f;
+                levels[code].low = low;
+                levels[code].high = high;
+                levels[code].fraction = static_cast<uint8_t>(fraction * 255.0f + 0.5f);
+            }
+        }
+
+        // bit_depth is the one the driver is built with
+        static inline void build_table(table_t &table, uint8_t bit_depth, bool gamma)
+        {
+            build_channel(table.red, 5, bit_depth, gamma);
+            build_channel(table.green, 6, bit_depth, gamma);
+            build_channel(table.blue, 5, bit_depth, gamma);
+        }
+
+        // Frames are dithered with thresholds shifted by the phase, so that every pixel goes through all of them
+        static inline uint8_t phase(uint32_t frame)
+        {
+            return static_cast<uint8_t>((frame * 7) & 15);
+        }
+
+        // Dithers width pixels of row y starting at column x
+        static inline void dither_row(const uint16_t *source, uint16_t *destination, int32_t width, int32_t x, int32_t y, uint8_t phase, const table_t &table)
+        {
+            const uint8_t *thresholds = &THRESHOLDS[(y & 3) * 4];
+            for (int32_t index = 0; index < width; index++)
+            {
+                const uint8_t threshold = static_cast<uint8_t>((((thresholds[(x + index) & 3] + phase) & 15) << 4) | 8);
+                const uint16_t pixel = source[index];
+                const level_t &red = table.red[pixel >> 11];
+                const level_t &green = table.green[(pixel >> 5) & 0x3F];
+                const level_t &blue = table.blue[pixel & 0x1F];
+                destination[index] = static_cast<uint16_t>(
+                    ((red.fraction > threshold ? red.high : red.low) << 11) |
+                    ((green.fraction > threshold ? green.high : green.low) << 5) |
+                    (blue.fraction > threshold ? blue.high : blue.low));
+            }
+        }
+    }
+}
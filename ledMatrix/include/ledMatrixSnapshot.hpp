@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string.h>
+#include <snapshot.hpp>
+
+// Snapshot of an RGB565 frame, in the 'P' format: the header of snapshot.hpp, then runs of identical pixels in row order.
+// A run is a color token followed by its length as a LEB128 varint, the token being:
+// - below DEFINE, the index of a color of the palette,
+// - DEFINE and a little endian uint16_t color, which becomes the next color of the palette,
+// - LITERAL and a little endian uint16_t color, once the palette is full.
+// The palette is built while encoding, a decoder rebuilds it from the DEFINE tokens.
+
+namespace macdap
+{
+    namespace snapshot
+    {
+        static constexpr uint8_t DEFINE = 0xFE;
+        static constexpr uint8_t LITERAL = 0xFF;
+        static constexpr uint16_t PALETTE_SIZE = DEFINE;
+
+        // Open addressing from color to palette index, twice the palette size so that probes stay short
+        typedef struct {
+            uint16_t colors[PALETTE_SIZE];
+            uint8_t slots[2 * 256];         // Palette index + 1, 0 when free
+            uint16_t color_nb;
+        } palette_t;
+
+        static inline size_t slot(const palette_t &palette, uint16_t color)
+        {
+            size_t index = ((color * 40503u) >> 7) & (sizeof(palette.slots) - 1);
+            while (palette.slots[index] != 0 && palette.colors[palette.slots[index] - 1] != color)
+            {
+                index = (index + 1) & (sizeof(palette.slots) - 1);
+            }
+            return index;
+        }
+
+        static inline void put_run(writer_t &writer, palette_t &palette, uint16_t color, uint32_t run)
+        {
+            size_t index = slot(palette, color);
+            if (palette.slots[index] != 0)
+            {
+                put(writer, palette.slots[index] - 1);
+            }
+            else if (palette.color_nb < PALETTE_SIZE)
+            {
+                palette.colors[palette.color_nb] = color;
+                palette.slots[index] = static_cast<uint8_t>(++palette.color_nb);
+                put(writer, DEFINE);
+                put_uint16(writer, color);
+            }
+            else
+            {
+                put(writer, LITERAL);
+                put_uint16(writer, color);
+            }
+            put_varint(writer, run);
+        }
+
+        // Rows of pixels are stride pixels apart, returns the snapshot length even if larger than size
+        static inline size_t encode_rgb565(const uint16_t *pixels, uint16_t width, uint16_t height, int32_t stride, uint8_t *buffer, size_t size)
+        {
+            writer_t writer = {buffer, size, 0};
+            put_header(writer, 'P', width, height);
+            if (width == 0 || height == 0)
+            {
+                return writer.length;
+            }
+
+            palette_t palette;
+            memset(palette.slots, 0, sizeof(palette.slots));
+            palette.color_nb = 0;
+
+            uint16_t color = pixels[0];
+            uint32_t run = 0;
+            for (int32_t y = 0; y < height; y++)
+            {
+                const uint16_t *row = pixels + y * stride;
+                for (int32_t x = 0; x < width; x++)
+                {
+                    if (row[x] != color)
+                    {
+                        put_run(writer, palette, color, run);
+                        color = row[x];
+                        run = 0;
+                    }
+                    run++;
+                }
+            }
+            put_run(writer, palette, color, run);
+            return writer.length;
+        }
+    }
+}
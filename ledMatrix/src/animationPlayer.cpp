@@ -0,0 +1,217 @@
+#include <animationPlayer.hpp>
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <string.h>
+
+using namespace macdap;
+
+static const char *TAG = "animationPlayer";
+
+void AnimationPlayer::play_task(void *arg)
+{
+    AnimationPlayer *player = static_cast<AnimationPlayer*>(arg);
+    const uint16_t width = player->m_header.width;
+    const uint16_t height = player->m_header.height;
+    const size_t pixel_nb = static_cast<size_t>(width) * height;
+    const TickType_t frame_period = pdMS_TO_TICKS(player->m_header.frame_period_ms) > 0 ? pdMS_TO_TICKS(player->m_header.frame_period_ms) : 1;
+    TickType_t wake_time = xTaskGetTickCount();
+
+    // The back buffer of a double buffered driver still holds the frame before the previous one,
+    // the rows changed since then are redrawn too
+    const bool double_buffered = player->m_ledMatrix.is_double_buffered();
+    animation::changed_span_t previous_changed = {0, pixel_nb - 1};
+
+    do
+    {
+        memset(player->m_canvas, 0, pixel_nb * sizeof(uint16_t));
+
+        for (uint32_t frame = 0; frame < player->m_header.frame_count && !player->m_stop; frame++)
+        {
+            uint32_t offset = animation::read_offset(player->m_animation, frame);
+            uint32_t frame_size = animation::read_offset(player->m_animation, frame + 1) - offset;
+
+            animation::changed_span_t changed;
+            if (!animation::decode_frame(player->m_animation + offset, frame_size, player->m_canvas, pixel_nb, &changed))
+            {
+                ESP_LOGE(TAG, "Frame %lu is corrupted", frame);
+                player->m_stop = true;
+                break;
+            }
+
+            // Frame 0 starts over from black, every row has to be drawn
+            if (frame == 0)
+            {
+                changed.first = 0;
+                changed.last = pixel_nb - 1;
+            }
+
+            if (double_buffered)
+            {
+                animation::changed_span_t drawn = changed;
+                if (changed.first > changed.last)
+                {
+                    drawn = previous_changed;
+                }
+                else if (previous_changed.first <= previous_changed.last)
+                {
+                    drawn.first = changed.first < previous_changed.first ? changed.first : previous_changed.first;
+                    drawn.last = changed.last > previous_changed.last ? changed.last : previous_changed.last;
+                }
+                previous_changed = changed;
+                changed = drawn;
+            }
+
+            if (changed.first <= changed.last)
+            {
+                uint16_t first_row = changed.first / width;
+                uint16_t last_row = changed.last / width;
+                player->m_ledMatrix.blit(0, first_row, width, last_row - first_row + 1, player->m_canvas + first_row * width);
+            }
+            player->m_ledMatrix.present();
+
+            vTaskDelayUntil(&wake_time, frame_period);
+        }
+    } while (player->m_loop && !player->m_stop);
+
+    player->m_ledMatrix.set_direct_mode(false);
+    player->m_playing = false;
+    xSemaphoreGive(player->m_done_semaphore);
+    vTaskDelete(nullptr);
+}
+
+AnimationPlayer::AnimationPlayer(LedMatrix &ledMatrix) : m_ledMatrix(ledMatrix)
+{
+    m_mmap_handle = 0;
+    m_animation = nullptr;
+    m_animation_size = 0;
+    memset(&m_header, 0, sizeof(m_header));
+    m_canvas = nullptr;
+    m_task_handle = nullptr;
+    m_stop = false;
+    m_playing = false;
+    m_loop = false;
+
+    m_done_semaphore = xSemaphoreCreateBinary();
+    if (m_done_semaphore == nullptr)
+    {
+        ESP_LOGE(TAG, "Create done semaphore failure!");
+    }
+}
+
+AnimationPlayer::~AnimationPlayer()
+{
+    stop();
+    close();
+    if (m_done_semaphore != nullptr)
+    {
+        vSemaphoreDelete(m_done_semaphore);
+    }
+}
+
+void AnimationPlayer::close()
+{
+    if (m_animation != nullptr)
+    {
+        esp_partition_munmap(m_mmap_handle);
+        m_animation = nullptr;
+        m_animation_size = 0;
+    }
+    if (m_canvas != nullptr)
+    {
+        heap_caps_free(m_canvas);
+        m_canvas = nullptr;
+    }
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+// Maps the animation stored in a data partition, its resolution has to be the one of the matrix
+esp_err_t AnimationPlayer::open(const char *partition_label)
+{
+    stop();
+    close();
+
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, partition_label);
+    if (partition == nullptr)
+    {
+        ESP_LOGE(TAG, "Partition %s not found", partition_label);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const void *mapping;
+    esp_err_t err = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &mapping, &m_mmap_handle);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Partition %s mmap failure: %s", partition_label, esp_err_to_name(err));
+        return err;
+    }
+    m_animation = static_cast<const uint8_t*>(mapping);
+    m_animation_size = partition->size;
+
+    if (!animation::validate(m_animation, m_animation_size))
+    {
+        ESP_LOGE(TAG, "Partition %s does not hold a valid animation", partition_label);
+        close();
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    memcpy(&m_header, m_animation, sizeof(m_header));
+
+    lv_display_t *display = m_ledMatrix.get_lv_display();
+    if (m_header.width != lv_display_get_horizontal_resolution(display) || m_header.height != lv_display_get_vertical_resolution(display))
+    {
+        ESP_LOGE(TAG, "Animation is %ux%u, matrix is %ldx%ld", m_header.width, m_header.height,
+                 lv_display_get_horizontal_resolution(display), lv_display_get_vertical_resolution(display));
+        close();
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // Decoded frames stay in internal RAM, the animation itself is read from flash through the cache
+    m_canvas = static_cast<uint16_t*>(heap_caps_malloc(m_header.width * m_header.height * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    if (m_canvas == nullptr)
+    {
+        ESP_LOGE(TAG, "Canvas allocation failure!");
+        close();
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Animation %s: %ux%u, %u frames every %u ms, %lu bytes", partition_label, m_header.width, m_header.height,
+             m_header.frame_count, m_header.frame_period_ms, animation::read_offset(m_animation, m_header.frame_count));
+    return ESP_OK;
+}
+
+// Takes the matrix over from LVGL until the animation ends, or forever when looping until stop() is called
+esp_err_t AnimationPlayer::play(bool loop)
+{
+    stop();
+
+    if (m_canvas == nullptr || m_done_semaphore == nullptr)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    m_loop = loop;
+    m_stop = false;
+    m_playing = true;
+    m_ledMatrix.set_direct_mode(true);
+
+    if (xTaskCreate(play_task, "animationPlayer", CONFIG_LED_MATRIX_ANIMATION_TASK_STACK_SIZE, this, CONFIG_LED_MATRIX_ANIMATION_TASK_PRIORITY, &m_task_handle) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Create play task failure!");
+        m_task_handle = nullptr;
+        m_playing = false;
+        m_ledMatrix.set_direct_mode(false);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+// Waits for the play task to end, the matrix then being back to LVGL
+void AnimationPlayer::stop()
+{
+    if (m_task_handle == nullptr)
+    {
+        return;
+    }
+    m_stop = true;
+    xSemaphoreTake(m_done_semaphore, portMAX_DELAY);
+    m_task_handle = nullptr;
+}
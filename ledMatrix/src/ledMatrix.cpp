@@ -1,33 +1,299 @@
 #include <ledMatrix.hpp>
-#include "hub75.h"
 #include <esp_log.h>
+#include <string.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <ledMatrixSnapshot.hpp>
+#ifdef CONFIG_LED_MATRIX_DITHERING
+#include <ledMatrixDither.hpp>
+#endif
 
 using namespace macdap;
 
 static const char *TAG = "ledMatrix";
 
-static void flush_cb(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+#ifdef CONFIG_LED_MATRIX_DITHERING
+#define DITHER_STRIPE_ROWS 8
+
+// Dithered down to the bit depth the driver is built with, the CMake override taking precedence as in the driver
+#if defined(HUB75_BIT_DEPTH)
+#define DITHER_BIT_DEPTH HUB75_BIT_DEPTH
+#elif defined(CONFIG_HUB75_BIT_DEPTH)
+#define DITHER_BIT_DEPTH CONFIG_HUB75_BIT_DEPTH
+#else
+#error "Dithering needs the HUB75 driver bit depth"
+#endif
+
+#ifdef CONFIG_LED_MATRIX_DITHER_GAMMA_CIE1931
+#define DITHER_GAMMA true
+#else
+#define DITHER_GAMMA false
+#endif
+
+static dither::table_t _dither_table;
+#endif
+
+#ifdef CONFIG_LED_MATRIX_PIPELINED_FLUSH
+typedef struct {
+    LedMatrix *ledMatrix;
+    lv_area_t area;
+    uint8_t *px_map;
+    bool last;
+} flush_job_t;
+
+// LVGL waits for flush ready before flushing a display again, there is never more than one job pending per matrix
+#define FLUSH_QUEUE_LENGTH 4
+
+// Shared by all the matrices, each worker converting whichever job comes next
+static QueueHandle_t _flush_queue = nullptr;
+#endif
+
+#ifdef CONFIG_LED_MATRIX_DITHERING
+// Dithered a stripe at a time, the driver copying the pixels into its DMA buffers
+void LedMatrix::dither_pixels(int32_t x, int32_t y, int32_t width, int32_t height, const uint16_t *pixels, int32_t stride)
+{
+    const uint8_t phase = dither::phase(m_dither_frame);
+    for (int32_t row = 0; row < height; row += DITHER_STRIPE_ROWS)
+    {
+        int32_t rows = height - row < DITHER_STRIPE_ROWS ? height - row : DITHER_STRIPE_ROWS;
+        for (int32_t stripe_row = 0; stripe_row < rows; stripe_row++)
+        {
+            dither::dither_row(pixels + (row + stripe_row) * stride, m_dither_stripe + stripe_row * width, width, x, y + row + stripe_row, phase, _dither_table);
+        }
+        m_driver->draw_pixels(x, y + row, width, rows, reinterpret_cast<const uint8_t*>(m_dither_stripe), Hub75PixelFormat::RGB565);
+    }
+}
+#endif
+
+// Caller holds the driver mutex, rows of pixels are stride pixels apart
+void LedMatrix::draw_pixels(int32_t x, int32_t y, int32_t width, int32_t height, const uint16_t *pixels, int32_t stride)
+{
+#ifdef CONFIG_LED_MATRIX_DITHERING
+#ifdef CONFIG_LED_MATRIX_DITHER_TEMPORAL
+    // Retained for the dither task to dither again with the next phases
+    for (int32_t row = 0; row < height; row++)
+    {
+        memcpy(m_dither_source + (y + row) * m_horizontal_resolution + x, pixels + row * stride, width * sizeof(uint16_t));
+    }
+#endif
+    dither_pixels(x, y, width, height, pixels, stride);
+#else
+    if (stride == width)
+    {
+        m_driver->draw_pixels(x, y, width, height, reinterpret_cast<const uint8_t*>(pixels), Hub75PixelFormat::RGB565);
+        return;
+    }
+    // The driver takes packed rows
+    for (int32_t row = 0; row < height; row++)
+    {
+        m_driver->draw_pixels(x, y + row, width, 1, reinterpret_cast<const uint8_t*>(pixels + row * stride), Hub75PixelFormat::RGB565);
+    }
+#endif
+}
+
+void LedMatrix::draw_area(const lv_area_t *area, uint8_t *px_map, bool last)
 {
-    Hub75Driver *driver = static_cast<Hub75Driver*>(lv_display_get_user_data(display));
- 
     const uint16_t x = area->x1;
     const uint16_t y = area->y1;
     const uint16_t w = area->x2 - area->x1 + 1;
     const uint16_t h = area->y2 - area->y1 + 1;
 
-    driver->draw_pixels(x, y, w, h, px_map, Hub75PixelFormat::RGB565);
+    int64_t flush_start_us = esp_timer_get_time();
+    int64_t flip_us = 0;
+
+    // In direct mode the panel belongs to blit(), LVGL keeps rendering but its frames are dropped
+    xSemaphoreTake(m_driver_mutex, portMAX_DELAY);
+    int64_t driver_wait_us = esp_timer_get_time() - flush_start_us;
+    if (!m_direct_mode && m_driver != nullptr)
+    {
+        draw_pixels(x, y, w, h, reinterpret_cast<const uint16_t*>(px_map), w);
+#ifndef CONFIG_LED_MATRIX_RENDER_MODE_PARTIAL
+        if (last)
+        {
+            m_last_frame = px_map;
+        }
+#endif
+
+        if (last && m_config.double_buffer)
+        {
+            int64_t flip_start_us = esp_timer_get_time();
+            m_driver->flip_buffer();
+            flip_us = esp_timer_get_time() - flip_start_us;
+        }
+    }
+    xSemaphoreGive(m_driver_mutex);
 
-    #ifdef CONFIG_HUB75_DOUBLE_BUFFER
-    driver->flip_buffer();
-    #endif
+    uint32_t flush_us = static_cast<uint32_t>(esp_timer_get_time() - flush_start_us);
+    xSemaphoreTake(m_stats_mutex, portMAX_DELAY);
+    m_stats.bus_wait_us += driver_wait_us + flip_us;
+    m_stats.flush_count++;
+    if (last)
+    {
+        m_stats.frame_count++;
+    }
+    m_stats.pixels_converted += w * h;
+    m_stats.bytes_transmitted += w * h * sizeof(uint16_t);
+    m_flush_total_us += flush_us;
+    if (flush_us < m_stats.flush_min_us)
+    {
+        m_stats.flush_min_us = flush_us;
+    }
+    if (flush_us > m_stats.flush_max_us)
+    {
+        m_stats.flush_max_us = flush_us;
+    }
+    xSemaphoreGive(m_stats_mutex);
+}
 
+void LedMatrix::flush_cb(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+    LedMatrix *ledMatrix = static_cast<LedMatrix*>(lv_display_get_user_data(display));
+
+#ifdef CONFIG_LED_MATRIX_PIPELINED_FLUSH
+    // The flush task converts the area on the other core, LVGL renders into its other buffer meanwhile
+    flush_job_t flush_job = {
+        .ledMatrix = ledMatrix,
+        .area = *area,
+        .px_map = px_map,
+        .last = lv_display_flush_is_last(display)
+    };
+    ledMatrix->m_flush_pending = true;
+    xQueueSend(_flush_queue, &flush_job, portMAX_DELAY);
+#else
+    ledMatrix->draw_area(area, px_map, lv_display_flush_is_last(display));
     lv_disp_flush_ready(display);
+#endif
 }
 
-LedMatrix::LedMatrix()
+#ifdef CONFIG_LED_MATRIX_PIPELINED_FLUSH
+// px_map is handed back to LVGL only once it is written into the HUB75 DMA buffers
+void LedMatrix::flush_task(void *arg)
 {
-    ESP_LOGI(TAG, "Initializing");
+    flush_job_t flush_job;
+
+    while (true)
+    {
+        if (xQueueReceive(_flush_queue, &flush_job, portMAX_DELAY) == pdTRUE)
+        {
+            LedMatrix *ledMatrix = flush_job.ledMatrix;
+            ledMatrix->draw_area(&flush_job.area, flush_job.px_map, flush_job.last);
+            lv_disp_flush_ready(ledMatrix->m_display);
+            ledMatrix->m_flush_pending = false;
+        }
+    }
+}
+
+// One worker per core when there are two, the matrices being converted in parallel
+bool LedMatrix::start_flush_workers()
+{
+    _flush_queue = xQueueCreate(FLUSH_QUEUE_LENGTH, sizeof(flush_job_t));
+    if (_flush_queue == nullptr)
+    {
+        ESP_LOGE(TAG, "Create flush queue failure!");
+        return false;
+    }
+    for (int worker = 0; worker < CONFIG_LED_MATRIX_FLUSH_WORKER_NB; worker++)
+    {
+        BaseType_t core = worker == 0 ? CONFIG_LED_MATRIX_FLUSH_TASK_CORE : 1 - CONFIG_LED_MATRIX_FLUSH_TASK_CORE;
+        if (xTaskCreatePinnedToCore(flush_task, "ledMatrixFlush", CONFIG_LED_MATRIX_FLUSH_TASK_STACK_SIZE, nullptr, CONFIG_LED_MATRIX_FLUSH_TASK_PRIORITY, nullptr, core) != pdPASS)
+        {
+            ESP_LOGE(TAG, "Create flush task failure!");
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+#ifdef CONFIG_LED_MATRIX_DITHER_TEMPORAL
+// Dithers the retained frame again with the next phase, even when nothing new is drawn
+void LedMatrix::dither_task(void *arg)
+{
+    LedMatrix *ledMatrix = static_cast<LedMatrix*>(arg);
+    const TickType_t period = pdMS_TO_TICKS(1000 / CONFIG_LED_MATRIX_DITHER_FRAME_RATE) > 0 ? pdMS_TO_TICKS(1000 / CONFIG_LED_MATRIX_DITHER_FRAME_RATE) : 1;
+    TickType_t wake_time = xTaskGetTickCount();
+
+    while (true)
+    {
+        vTaskDelayUntil(&wake_time, period);
+
+        // In direct mode a frame of blit() calls is only shown by present(), not halfway through
+        xSemaphoreTake(ledMatrix->m_driver_mutex, portMAX_DELAY);
+        if (ledMatrix->m_direct_mode || ledMatrix->m_driver == nullptr)
+        {
+            xSemaphoreGive(ledMatrix->m_driver_mutex);
+            continue;
+        }
+        ledMatrix->m_dither_frame++;
+        ledMatrix->dither_pixels(0, 0, ledMatrix->m_horizontal_resolution, ledMatrix->m_vertical_resolution,
+                                 ledMatrix->m_dither_source, ledMatrix->m_horizontal_resolution);
+        if (ledMatrix->m_config.double_buffer)
+        {
+            ledMatrix->m_driver->flip_buffer();
+        }
+        xSemaphoreGive(ledMatrix->m_driver_mutex);
+    }
+}
+#endif
+
+void LedMatrix::stats_timer_callback(void *arg)
+{
+    LedMatrix *ledMatrix = static_cast<LedMatrix*>(arg);
+    led_matrix_stats_t stats = ledMatrix->get_stats();
+    ledMatrix->reset_stats();
+
+    ESP_LOGI(TAG, "%lu flushes, %.1f fps, flush %lu/%lu/%lu us (min/avg/max), bus wait %llu us, %llu pixels, %llu bytes",
+             stats.flush_count, stats.fps, stats.flush_min_us, stats.flush_avg_us, stats.flush_max_us,
+             stats.bus_wait_us, stats.pixels_converted, stats.bytes_transmitted);
+}
+
+static Hub75ClockSpeed to_clock_speed(uint32_t clock_speed_hz)
+{
+    if (clock_speed_hz >= 20000000)
+    {
+        return Hub75ClockSpeed::HZ_20M;
+    }
+    if (clock_speed_hz >= 16000000)
+    {
+        return Hub75ClockSpeed::HZ_16M;
+    }
+    if (clock_speed_hz >= 10000000)
+    {
+        return Hub75ClockSpeed::HZ_10M;
+    }
+    return Hub75ClockSpeed::HZ_8M;
+}
 
+static uint32_t to_clock_speed_hz(Hub75ClockSpeed clock_speed)
+{
+    switch (clock_speed)
+    {
+        case Hub75ClockSpeed::HZ_20M:
+            return 20000000;
+        case Hub75ClockSpeed::HZ_16M:
+            return 16000000;
+        case Hub75ClockSpeed::HZ_10M:
+            return 10000000;
+        default:
+            return 8000000;
+    }
+}
+
+static led_matrix_config_t to_config(const Hub75Config &driver_config)
+{
+    led_matrix_config_t config = {
+        .clock_speed_hz = to_clock_speed_hz(driver_config.output_clock_speed),
+        .min_refresh_rate = static_cast<uint16_t>(driver_config.min_refresh_rate),
+        .latch_blanking = static_cast<uint8_t>(driver_config.latch_blanking),
+        .brightness = static_cast<uint8_t>(driver_config.brightness),
+        .double_buffer = driver_config.double_buffer
+    };
+    return config;
+}
+
+// The driver configuration of the menuconfig HUB75 settings, the one of get_instance()
+Hub75Config LedMatrix::get_default_driver_config()
+{
     Hub75Config config{};
 
     // Panel dimensions
@@ -245,18 +511,133 @@ LedMatrix::LedMatrix()
     config.gamma_mode = Hub75GammaMode::LINEAR;  // None is same as Linear
 #endif
 
-    // Create and start driver
-    Hub75Driver *driver = new Hub75Driver(config);
+    return config;
+}
+
+// Creates the driver, measuring the DMA capable memory it takes. Leaves m_driver null and the previous
+// configuration in place when the driver cannot start, e.g. out of DMA memory or with no LCD peripheral left.
+esp_err_t LedMatrix::start_driver(const Hub75Config &driver_config)
+{
+    size_t free_before = heap_caps_get_free_size(MALLOC_CAP_DMA);
+    m_driver = new Hub75Driver(driver_config);
     esp_log_level_set("GdmaDma", ESP_LOG_WARN);  // Silence GDMA init chatter, keep
-    driver->begin();
-    driver->clear();
+    if (!m_driver->begin())
+    {
+        ESP_LOGE(TAG, "Driver start failure!");
+        delete m_driver;
+        m_driver = nullptr;
+        return ESP_FAIL;
+    }
+    m_driver->clear();
+    size_t free_after = heap_caps_get_free_size(MALLOC_CAP_DMA);
+    m_driver_memory = free_before > free_after ? free_before - free_after : 0;
+    m_driver_config = driver_config;
+    m_config = to_config(driver_config);
+
+    ESP_LOGI(TAG, "Driver started: %lu Hz clock, %u Hz min refresh, %u latch blanking, %s buffered, %zu DMA bytes",
+             m_config.clock_speed_hz, m_config.min_refresh_rate, m_config.latch_blanking, m_config.double_buffer ? "double" : "single", m_driver_memory);
+    return ESP_OK;
+}
+
+LedMatrix::LedMatrix() : LedMatrix(get_default_driver_config())
+{
+}
+
+// Each matrix has its own HUB75 chain, given by the pins of config, and its own LVGL display
+LedMatrix::LedMatrix(const Hub75Config &config)
+{
+    ESP_LOGI(TAG, "Initializing");
+
+    m_display = nullptr;
+    m_driver = nullptr;
+    m_lv_buffer = nullptr;
+    m_lv_buffer_2 = nullptr;
+    m_last_frame = nullptr;
+    m_stats_timer = nullptr;
+#ifdef CONFIG_LED_MATRIX_PIPELINED_FLUSH
+    m_flush_pending = false;
+#endif
+#ifdef CONFIG_LED_MATRIX_DITHERING
+    m_dither_stripe = nullptr;
+#endif
+#ifdef CONFIG_LED_MATRIX_DITHER_TEMPORAL
+    m_dither_source = nullptr;
+    m_dither_task_handle = nullptr;
+#endif
+
+    m_stats_mutex = xSemaphoreCreateMutex();
+    if (m_stats_mutex == nullptr)
+    {
+        ESP_LOGE(TAG, "Create stats mutex failure!");
+        return;
+    }
+    reset_stats();
 
-    int32_t horizontal_resolution = CONFIG_HUB75_LAYOUT_COLS * CONFIG_HUB75_PANEL_WIDTH;
-    int32_t vertical_resolution = CONFIG_HUB75_LAYOUT_ROWS * CONFIG_HUB75_PANEL_HEIGHT;
+    m_driver_mutex = xSemaphoreCreateMutex();
+    if (m_driver_mutex == nullptr)
+    {
+        ESP_LOGE(TAG, "Create driver mutex failure!");
+        return;
+    }
+    m_direct_mode = false;
+
+    Hub75Config driver_config = config;
+#ifdef CONFIG_LED_MATRIX_RENDER_MODE_PARTIAL
+    if (driver_config.double_buffer)
+    {
+        ESP_LOGW(TAG, "Partial render mode needs a single buffered driver");
+        driver_config.double_buffer = false;
+    }
+#endif
+    if (start_driver(driver_config) != ESP_OK)
+    {
+        return;
+    }
+
+    int32_t horizontal_resolution = driver_config.layout_cols * driver_config.panel_width;
+    int32_t vertical_resolution = driver_config.layout_rows * driver_config.panel_height;
 
     ESP_LOGI(TAG, "Display resolution: %ld x %ld", horizontal_resolution, vertical_resolution);
+    m_horizontal_resolution = horizontal_resolution;
+    m_vertical_resolution = vertical_resolution;
+
+#ifdef CONFIG_LED_MATRIX_DITHERING
+    dither::build_table(_dither_table, DITHER_BIT_DEPTH, DITHER_GAMMA);
+    m_dither_frame = 0;
+    m_dither_stripe = static_cast<uint16_t*>(heap_caps_malloc(horizontal_resolution * DITHER_STRIPE_ROWS * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    if (m_dither_stripe == nullptr)
+    {
+        ESP_LOGE(TAG, "Failed to allocate dither stripe on the heap!");
+        return;
+    }
+#ifdef CONFIG_LED_MATRIX_DITHER_TEMPORAL
+    m_dither_source = static_cast<uint16_t*>(heap_caps_calloc(horizontal_resolution * vertical_resolution, sizeof(uint16_t), MALLOC_CAP_DEFAULT));
+    if (m_dither_source == nullptr)
+    {
+        ESP_LOGE(TAG, "Failed to allocate dither source frame on the heap!");
+        return;
+    }
+#endif
+    ESP_LOGI(TAG, "Dithering to %d bits", DITHER_BIT_DEPTH);
+#endif
 
     #define BYTES_PER_PIXEL (LV_COLOR_FORMAT_GET_SIZE(LV_COLOR_FORMAT_RGB565))
+#ifdef CONFIG_LED_MATRIX_RENDER_MODE_PARTIAL
+    // Two stripes in internal RAM, only the invalidated areas are rendered and converted
+    int32_t lv_buffer_rows = CONFIG_LED_MATRIX_PARTIAL_BUFFER_ROWS < vertical_resolution ? CONFIG_LED_MATRIX_PARTIAL_BUFFER_ROWS : vertical_resolution;
+    size_t lv_buffer_size = horizontal_resolution * lv_buffer_rows * BYTES_PER_PIXEL;
+    ESP_LOGI(TAG, "Allocating 2 lvBuffer stripes of %ld rows in internal RAM: %zu bytes each", lv_buffer_rows, lv_buffer_size);
+    uint8_t *lv_buffer = static_cast<uint8_t*>(heap_caps_malloc(lv_buffer_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    uint8_t *lv_buffer_2 = static_cast<uint8_t*>(heap_caps_malloc(lv_buffer_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    if (lv_buffer == nullptr || lv_buffer_2 == nullptr)
+    {
+        ESP_LOGE(TAG, "Failed to allocate lvBuffer stripes on the heap!");
+        heap_caps_free(lv_buffer);
+        heap_caps_free(lv_buffer_2);
+        return;
+    }
+    lv_display_render_mode_t render_mode = LV_DISPLAY_RENDER_MODE_PARTIAL;
+#else
     size_t lv_buffer_size = horizontal_resolution * vertical_resolution * BYTES_PER_PIXEL;
 #if defined(CONFIG_SPIRAM)
     ESP_LOGI(TAG, "Allocating lvBuffer in SPIRAM: %zu bytes", lv_buffer_size);
@@ -270,15 +651,101 @@ LedMatrix::LedMatrix()
         ESP_LOGE(TAG, "Failed to allocate lvBuffer on the heap!");
         return;
     }
+#ifdef CONFIG_LED_MATRIX_PIPELINED_FLUSH
+    // A second frame for LVGL to render into while the first one is converted
+#if defined(CONFIG_SPIRAM)
+    uint8_t *lv_buffer_2 = static_cast<uint8_t*>(heap_caps_malloc(lv_buffer_size, MALLOC_CAP_SPIRAM));
+#else
+    uint8_t *lv_buffer_2 = static_cast<uint8_t*>(heap_caps_malloc(lv_buffer_size, MALLOC_CAP_DEFAULT));
+#endif
+    if (lv_buffer_2 == nullptr)
+    {
+        ESP_LOGE(TAG, "Failed to allocate second lvBuffer on the heap!");
+        heap_caps_free(lv_buffer);
+        return;
+    }
+#else
+    uint8_t *lv_buffer_2 = nullptr;
+#endif
+    lv_display_render_mode_t render_mode = LV_DISPLAY_RENDER_MODE_FULL;
+#endif
+
+#ifdef CONFIG_LED_MATRIX_PIPELINED_FLUSH
+    static bool flush_workers_started = start_flush_workers();
+    if (!flush_workers_started)
+    {
+        heap_caps_free(lv_buffer);
+        heap_caps_free(lv_buffer_2);
+        return;
+    }
+#endif
+    m_lv_buffer = lv_buffer;
+    m_lv_buffer_2 = lv_buffer_2;
 
     m_display = lv_display_create(horizontal_resolution, vertical_resolution);
     lv_display_set_flush_cb(m_display, flush_cb);
-    lv_display_set_user_data(m_display, driver);
-    lv_display_set_buffers(m_display, lv_buffer, NULL, lv_buffer_size, LV_DISPLAY_RENDER_MODE_FULL);
+    lv_display_set_user_data(m_display, this);
+    lv_display_set_buffers(m_display, lv_buffer, lv_buffer_2, lv_buffer_size, render_mode);
+
+#ifdef CONFIG_LED_MATRIX_DITHER_TEMPORAL
+    if (xTaskCreate(dither_task, "ledMatrixDither", CONFIG_LED_MATRIX_DITHER_TASK_STACK_SIZE, this, CONFIG_LED_MATRIX_DITHER_TASK_PRIORITY, &m_dither_task_handle) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Create dither task failure!");
+        return;
+    }
+#endif
+
+    if (CONFIG_LED_MATRIX_STATS_LOG_INTERVAL_SEC != 0)
+    {
+        esp_timer_create_args_t timer_args = {
+            .callback = stats_timer_callback,
+            .arg = this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "LedMatrixStatsTimer",
+            .skip_unhandled_events = true
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &m_stats_timer));
+        ESP_ERROR_CHECK(esp_timer_start_periodic(m_stats_timer, CONFIG_LED_MATRIX_STATS_LOG_INTERVAL_SEC * 1000000));
+    }
 }
 
 LedMatrix::~LedMatrix()
 {
+    if (m_display != nullptr && lvgl_port_lock(0))
+    {
+        lv_display_delete(m_display);
+        lvgl_port_unlock();
+    }
+#ifdef CONFIG_LED_MATRIX_PIPELINED_FLUSH
+    // A flush job may still point to this matrix
+    while (m_flush_pending)
+    {
+        vTaskDelay(1);
+    }
+#endif
+#ifdef CONFIG_LED_MATRIX_DITHER_TEMPORAL
+    if (m_dither_task_handle != nullptr)
+    {
+        // Not while it holds the driver
+        xSemaphoreTake(m_driver_mutex, portMAX_DELAY);
+        vTaskDelete(m_dither_task_handle);
+        xSemaphoreGive(m_driver_mutex);
+    }
+    heap_caps_free(m_dither_source);
+#endif
+#ifdef CONFIG_LED_MATRIX_DITHERING
+    heap_caps_free(m_dither_stripe);
+#endif
+    if (m_stats_timer != nullptr)
+    {
+        esp_timer_stop(m_stats_timer);
+        esp_timer_delete(m_stats_timer);
+    }
+    delete m_driver;
+    heap_caps_free(m_lv_buffer);
+    heap_caps_free(m_lv_buffer_2);
+    vSemaphoreDelete(m_driver_mutex);
+    vSemaphoreDelete(m_stats_mutex);
 }
 
 lv_display_t *LedMatrix::get_lv_display()
@@ -288,12 +755,219 @@ lv_display_t *LedMatrix::get_lv_display()
 
 void LedMatrix::set_brightness(uint8_t brightness)
 {
-    Hub75Driver *driver = static_cast<Hub75Driver*>(lv_display_get_user_data(m_display));
-    driver->set_brightness(brightness);
+    xSemaphoreTake(m_driver_mutex, portMAX_DELAY);
+    if (m_driver != nullptr)
+    {
+        m_driver->set_brightness(brightness);
+    }
+    m_config.brightness = brightness;
+    m_driver_config.brightness = brightness;
+    xSemaphoreGive(m_driver_mutex);
 }
 
 void LedMatrix::set_intensity(float intensity)
 {
-    Hub75Driver *driver = static_cast<Hub75Driver*>(lv_display_get_user_data(m_display));
-    driver->set_intensity(intensity);
+    xSemaphoreTake(m_driver_mutex, portMAX_DELAY);
+    if (m_driver != nullptr)
+    {
+        m_driver->set_intensity(intensity);
+    }
+    xSemaphoreGive(m_driver_mutex);
+}
+
+led_matrix_config_t LedMatrix::get_config()
+{
+    xSemaphoreTake(m_driver_mutex, portMAX_DELAY);
+    led_matrix_config_t config = m_config;
+    xSemaphoreGive(m_driver_mutex);
+    return config;
+}
+
+// DMA capable memory taken by the driver when it was started
+size_t LedMatrix::get_driver_memory()
+{
+    xSemaphoreTake(m_driver_mutex, portMAX_DELAY);
+    size_t driver_memory = m_driver_memory;
+    xSemaphoreGive(m_driver_mutex);
+    return driver_memory;
+}
+
+// Restarts the driver with other timing settings, the panel being blank until the next frame is drawn.
+// The bit depth and gamma are compiled into the driver and cannot change at runtime.
+// When the new settings fail to start the driver, it is restarted with the previous ones and the error returned.
+esp_err_t LedMatrix::reconfigure(const led_matrix_config_t &config)
+{
+    if (config.clock_speed_hz == 0 || config.min_refresh_rate == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+#ifdef CONFIG_LED_MATRIX_RENDER_MODE_PARTIAL
+    // Partial areas are drawn into a single buffer, a flipped one would miss them
+    if (config.double_buffer)
+    {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+#endif
+
+    xSemaphoreTake(m_driver_mutex, portMAX_DELAY);
+    Hub75Config driver_config = m_driver_config;
+    driver_config.output_clock_speed = to_clock_speed(config.clock_speed_hz);
+    driver_config.min_refresh_rate = config.min_refresh_rate;
+    driver_config.latch_blanking = config.latch_blanking;
+    driver_config.brightness = config.brightness;
+    driver_config.double_buffer = config.double_buffer;
+    delete m_driver;
+    esp_err_t err = start_driver(driver_config);
+    if (err != ESP_OK && start_driver(m_driver_config) != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Previous settings restore failure!");
+    }
+    xSemaphoreGive(m_driver_mutex);
+
+    if (!m_direct_mode && lvgl_port_lock(0))
+    {
+        lv_obj_invalidate(lv_display_get_screen_active(m_display));
+        lvgl_port_unlock();
+    }
+    return err;
+}
+
+// Hands the panel over to blit() and present(), or back to LVGL which then redraws its whole screen
+void LedMatrix::set_direct_mode(bool enabled)
+{
+    xSemaphoreTake(m_driver_mutex, portMAX_DELAY);
+    m_direct_mode = enabled;
+    xSemaphoreGive(m_driver_mutex);
+
+    if (!enabled && lvgl_port_lock(0))
+    {
+        lv_obj_invalidate(lv_display_get_screen_active(m_display));
+        lvgl_port_unlock();
+    }
+}
+
+// Writes pre-rendered RGB565 pixels straight into the HUB75 bit-planes, without going through an LVGL frame.
+// Rows of pixels are width pixels apart, the driver applies the gamma and brightness while encoding the bit-planes.
+esp_err_t LedMatrix::blit(int32_t x, int32_t y, int32_t width, int32_t height, const uint16_t *pixels)
+{
+    if (!m_direct_mode)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (pixels == nullptr || x < 0 || y < 0 || width <= 0 || height <= 0 ||
+        x + width > m_horizontal_resolution || y + height > m_vertical_resolution)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t driver_wait_start_us = esp_timer_get_time();
+    xSemaphoreTake(m_driver_mutex, portMAX_DELAY);
+    int64_t driver_wait_us = esp_timer_get_time() - driver_wait_start_us;
+    if (m_driver == nullptr)
+    {
+        xSemaphoreGive(m_driver_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+    draw_pixels(x, y, width, height, pixels, width);
+    xSemaphoreGive(m_driver_mutex);
+
+    xSemaphoreTake(m_stats_mutex, portMAX_DELAY);
+    m_stats.bus_wait_us += driver_wait_us;
+    m_stats.pixels_converted += width * height;
+    m_stats.bytes_transmitted += width * height * sizeof(uint16_t);
+    xSemaphoreGive(m_stats_mutex);
+
+    return ESP_OK;
+}
+
+// Ends a frame of blit() calls, showing it when the driver is double buffered
+void LedMatrix::present()
+{
+    int64_t flip_us = 0;
+
+    int64_t driver_wait_start_us = esp_timer_get_time();
+    xSemaphoreTake(m_driver_mutex, portMAX_DELAY);
+    int64_t driver_wait_us = esp_timer_get_time() - driver_wait_start_us;
+    if (m_config.double_buffer && m_driver != nullptr)
+    {
+        int64_t flip_start_us = esp_timer_get_time();
+        m_driver->flip_buffer();
+        flip_us = esp_timer_get_time() - flip_start_us;
+    }
+    xSemaphoreGive(m_driver_mutex);
+
+    xSemaphoreTake(m_stats_mutex, portMAX_DELAY);
+    m_stats.frame_count++;
+    m_stats.bus_wait_us += driver_wait_us + flip_us;
+    xSemaphoreGive(m_stats_mutex);
+}
+
+// RGB565 palette and run length encoding of what the matrix shows, see ledMatrixSnapshot.hpp.
+// Taken from the retained frame of the temporal dithering, or else from the last frame LVGL rendered, which only
+// holds the whole screen in full render mode. length is set to the needed size even when it does not fit.
+esp_err_t LedMatrix::get_snapshot(uint8_t *buffer, size_t size, size_t *length)
+{
+    size_t snapshot_length = 0;
+
+#ifdef CONFIG_LED_MATRIX_DITHER_TEMPORAL
+    xSemaphoreTake(m_driver_mutex, portMAX_DELAY);
+    snapshot_length = snapshot::encode_rgb565(m_dither_source, m_horizontal_resolution, m_vertical_resolution, m_horizontal_resolution, buffer, size);
+    xSemaphoreGive(m_driver_mutex);
+#elif CONFIG_LED_MATRIX_RENDER_MODE_PARTIAL
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    // LVGL does not render into a flushed frame while its lock is held
+    if (!lvgl_port_lock(0))
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    xSemaphoreTake(m_driver_mutex, portMAX_DELAY);
+    const uint8_t *frame = m_direct_mode ? nullptr : m_last_frame;
+    xSemaphoreGive(m_driver_mutex);
+
+    if (frame == nullptr)
+    {
+        // Nothing rendered yet, or the panel shows what blit() drew
+        lvgl_port_unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+    snapshot_length = snapshot::encode_rgb565(reinterpret_cast<const uint16_t*>(frame), m_horizontal_resolution, m_vertical_resolution, m_horizontal_resolution, buffer, size);
+    lvgl_port_unlock();
+#endif
+
+    if (length != nullptr)
+    {
+        *length = snapshot_length;
+    }
+    return snapshot_length <= size ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+led_matrix_stats_t LedMatrix::get_stats()
+{
+    xSemaphoreTake(m_stats_mutex, portMAX_DELAY);
+    led_matrix_stats_t stats = m_stats;
+    uint64_t flush_total_us = m_flush_total_us;
+    int64_t elapsed_us = esp_timer_get_time() - m_stats_start_us;
+    xSemaphoreGive(m_stats_mutex);
+
+    if (stats.flush_count == 0)
+    {
+        stats.flush_min_us = 0;
+    }
+    else
+    {
+        stats.flush_avg_us = static_cast<uint32_t>(flush_total_us / stats.flush_count);
+    }
+    stats.fps = elapsed_us > 0 ? stats.frame_count * 1000000.0f / elapsed_us : 0.0f;
+    return stats;
+}
+
+void LedMatrix::reset_stats()
+{
+    xSemaphoreTake(m_stats_mutex, portMAX_DELAY);
+    m_stats = {};
+    m_stats.flush_min_us = UINT32_MAX;
+    m_flush_total_us = 0;
+    m_stats_start_us = esp_timer_get_time();
+    xSemaphoreGive(m_stats_mutex);
 }
@@ -0,0 +1,171 @@
+// Host side animation encoder, turns a sequence of binary PPM (P6) frames into an animation for AnimationPlayer.
+// Build with: g++ -O2 -std=c++17 -I ../../include animationEncoder.cpp -o animationEncoder
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <animationEncoder.hpp>
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [-r fps | -p period_ms] -o output.lma frame_0000.ppm [frame_0001.ppm ...]\n", program);
+}
+
+static bool read_token(FILE *file, std::string &token)
+{
+    token.clear();
+    int c = fgetc(file);
+    while (c != EOF)
+    {
+        if (c == '#')
+        {
+            while (c != EOF && c != '\n')
+            {
+                c = fgetc(file);
+            }
+        }
+        else if (isspace(c))
+        {
+            if (!token.empty())
+            {
+                return true;
+            }
+        }
+        else
+        {
+            token.push_back(static_cast<char>(c));
+        }
+        c = fgetc(file);
+    }
+    return !token.empty();
+}
+
+// Reads a P6 frame, converting it to RGB565
+static bool read_ppm(const char *path, uint16_t &width, uint16_t &height, std::vector<uint16_t> &pixels)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    std::string magic, width_token, height_token, max_token;
+    if (!read_token(file, magic) || magic != "P6" || !read_token(file, width_token) || !read_token(file, height_token) || !read_token(file, max_token))
+    {
+        fprintf(stderr, "%s: not a binary PPM\n", path);
+        fclose(file);
+        return false;
+    }
+    long frame_width = strtol(width_token.c_str(), nullptr, 10);
+    long frame_height = strtol(height_token.c_str(), nullptr, 10);
+    if (frame_width <= 0 || frame_width > 0xFFFF || frame_height <= 0 || frame_height > 0xFFFF || max_token != "255")
+    {
+        fprintf(stderr, "%s: unsupported size or depth\n", path);
+        fclose(file);
+        return false;
+    }
+
+    std::vector<uint8_t> rgb(frame_width * frame_height * 3);
+    if (fread(rgb.data(), 1, rgb.size(), file) != rgb.size())
+    {
+        fprintf(stderr, "%s: truncated\n", path);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+
+    width = static_cast<uint16_t>(frame_width);
+    height = static_cast<uint16_t>(frame_height);
+    pixels.resize(frame_width * frame_height);
+    for (size_t pixel = 0; pixel < pixels.size(); pixel++)
+    {
+        const uint8_t *color = &rgb[pixel * 3];
+        pixels[pixel] = static_cast<uint16_t>(((color[0] & 0xF8) << 8) | ((color[1] & 0xFC) << 3) | (color[2] >> 3));
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long frame_period_ms = 50;
+    const char *output_path = nullptr;
+    int argument = 1;
+
+    for (; argument < argc && argv[argument][0] == '-'; argument++)
+    {
+        if (argument + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[argument], "-r") == 0)
+        {
+            double fps = strtod(argv[++argument], nullptr);
+            if (fps <= 0)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            frame_period_ms = static_cast<unsigned long>(1000.0 / fps + 0.5);
+        }
+        else if (strcmp(argv[argument], "-p") == 0)
+        {
+            frame_period_ms = strtoul(argv[++argument], nullptr, 10);
+        }
+        else if (strcmp(argv[argument], "-o") == 0)
+        {
+            output_path = argv[++argument];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (output_path == nullptr || argument >= argc || frame_period_ms == 0 || frame_period_ms > 0xFFFF || argc - argument > 0xFFFF)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    uint16_t width = 0;
+    uint16_t height = 0;
+    std::vector<std::vector<uint16_t>> frames;
+    for (; argument < argc; argument++)
+    {
+        uint16_t frame_width = 0;
+        uint16_t frame_height = 0;
+        std::vector<uint16_t> pixels;
+        if (!read_ppm(argv[argument], frame_width, frame_height, pixels))
+        {
+            return 1;
+        }
+        if (!frames.empty() && (frame_width != width || frame_height != height))
+        {
+            fprintf(stderr, "%s: is %ux%u, previous frames are %ux%u\n", argv[argument], frame_width, frame_height, width, height);
+            return 1;
+        }
+        width = frame_width;
+        height = frame_height;
+        frames.push_back(std::move(pixels));
+    }
+
+    std::vector<uint8_t> animation = macdap::animation::encode(frames, width, height, static_cast<uint16_t>(frame_period_ms));
+
+    FILE *output = fopen(output_path, "wb");
+    if (output == nullptr || fwrite(animation.data(), 1, animation.size(), output) != animation.size())
+    {
+        fprintf(stderr, "%s: cannot write\n", output_path);
+        return 1;
+    }
+    fclose(output);
+
+    size_t raw_size = frames.size() * width * height * sizeof(uint16_t);
+    printf("%s: %zu frames %ux%u every %lu ms, %zu bytes (%.1f%% of %zu raw RGB565 bytes)\n", output_path, frames.size(), width, height,
+           frame_period_ms, animation.size(), 100.0 * animation.size() / raw_size, raw_size);
+    return 0;
+}
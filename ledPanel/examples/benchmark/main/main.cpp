@@ -0,0 +1,370 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include <ledPanelPacking.hpp>
+#include <ledPanelShift.hpp>
+
+#define PIXEL_PER_BYTE 8
+#define ITERATIONS 200
+
+using macdap::panel_geometry;
+using macdap::panel_rotation_t;
+
+// Panels as mounted in the field, upside down
+typedef panel_geometry<48, 16, panel_rotation_t::ROTATION_180> m6_16x8_3x2_t;
+typedef panel_geometry<96, 8, panel_rotation_t::ROTATION_180> m4_24x8_4x1_t;
+typedef panel_geometry<128, 8, panel_rotation_t::ROTATION_180> max_32x8_4x1_t;
+typedef panel_geometry<240, 80, panel_rotation_t::ROTATION_180> m4_24x8_10x10_t;
+
+// Per pixel packing as originally done by flush_cb, kept as the reference
+template <typename pixel_t>
+static void set_pixel_area(uint8_t *panel_buffer, int32_t horizontal_resolution, int32_t vertical_resolution, const pixel_t *px_map)
+{
+    for (int32_t y = 0; y < vertical_resolution; y++)
+    {
+        for (int32_t x = 0; x < horizontal_resolution; x++)
+        {
+            int16_t x_reverse = horizontal_resolution - 1 - x;
+            int16_t y_reverse = vertical_resolution - 1 - y;
+
+            uint16_t buffer_index = (y_reverse / PIXEL_PER_BYTE) * horizontal_resolution + x_reverse;
+            uint8_t segment = static_cast<uint8_t>(0x80 >> (y_reverse % PIXEL_PER_BYTE));
+            uint8_t buffer = panel_buffer[buffer_index];
+
+            if (*px_map != 0)
+            {
+                buffer = buffer | segment;
+            }
+            else
+            {
+                buffer = buffer & ~segment;
+            }
+            panel_buffer[buffer_index] = buffer;
+            px_map++;
+        }
+    }
+}
+
+template <typename geometry_t, typename pixel_t>
+static void benchmark(const char *name)
+{
+    const int32_t pixels = geometry_t::WIDTH * geometry_t::HEIGHT;
+
+    std::vector<pixel_t> px_map(pixels);
+    for (auto &pixel : px_map)
+    {
+        pixel = (rand() & 1) ? static_cast<pixel_t>(rand() | 1) : 0;
+    }
+
+    std::vector<uint8_t> reference(geometry_t::BUFFER_SIZE, 0);
+    std::vector<uint8_t> packed(geometry_t::BUFFER_SIZE, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++)
+    {
+        set_pixel_area(reference.data(), geometry_t::WIDTH, geometry_t::HEIGHT, px_map.data());
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++)
+    {
+        macdap::pack_area<geometry_t>(packed.data(), 0, 0, geometry_t::WIDTH - 1, geometry_t::HEIGHT - 1, px_map.data());
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double before_s = std::chrono::duration<double>(middle - start).count();
+    double after_s = std::chrono::duration<double>(end - middle).count();
+    double total_pixels = static_cast<double>(pixels) * ITERATIONS;
+
+    printf("%-14s %3u bpp  set_pixel %8.2f Mpx/s  pack_area %8.2f Mpx/s  x%5.1f  %s\n",
+           name,
+           static_cast<unsigned>(8 * sizeof(pixel_t)),
+           total_pixels / before_s / 1e6,
+           total_pixels / after_s / 1e6,
+           before_s / after_s,
+           reference == packed ? "match" : "MISMATCH");
+}
+
+template <typename geometry_t>
+static void benchmark_i1(const char *name)
+{
+    const int32_t pixels = geometry_t::WIDTH * geometry_t::HEIGHT;
+    const size_t stride = (geometry_t::WIDTH + 7) / 8;
+
+    std::vector<uint8_t> i1_map(stride * geometry_t::HEIGHT);
+    std::vector<uint8_t> px_map(pixels);
+    for (int32_t y = 0; y < geometry_t::HEIGHT; y++)
+    {
+        for (int32_t x = 0; x < geometry_t::WIDTH; x++)
+        {
+            px_map[y * geometry_t::WIDTH + x] = rand() & 1;
+            if (px_map[y * geometry_t::WIDTH + x])
+            {
+                i1_map[y * stride + x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+    }
+
+    std::vector<uint8_t> reference(geometry_t::BUFFER_SIZE, 0);
+    std::vector<uint8_t> packed(geometry_t::BUFFER_SIZE, 0);
+
+    set_pixel_area(reference.data(), geometry_t::WIDTH, geometry_t::HEIGHT, px_map.data());
+
+    auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++)
+    {
+        macdap::pack_area_i1<geometry_t>(packed.data(), 0, 0, geometry_t::WIDTH - 1, geometry_t::HEIGHT - 1, i1_map.data(), stride);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double after_s = std::chrono::duration<double>(end - start).count();
+    double total_pixels = static_cast<double>(pixels) * ITERATIONS;
+
+    printf("%-14s   I1   pack_area_i1 %8.2f Mpx/s  %s\n",
+           name,
+           total_pixels / after_s / 1e6,
+           reference == packed ? "match" : "MISMATCH");
+}
+
+// Mirrors then rotates clockwise, written independently of panel_geometry to check it
+template <typename geometry_t, panel_rotation_t ROTATION, bool MIRROR_X, bool MIRROR_Y>
+static void reference_map(int32_t x, int32_t y, int32_t &column, int32_t &row)
+{
+    if (MIRROR_X)
+    {
+        x = geometry_t::HORIZONTAL_RESOLUTION - 1 - x;
+    }
+    if (MIRROR_Y)
+    {
+        y = geometry_t::VERTICAL_RESOLUTION - 1 - y;
+    }
+    switch (ROTATION)
+    {
+        case panel_rotation_t::ROTATION_0:
+            column = x;
+            row = y;
+            break;
+        case panel_rotation_t::ROTATION_90:
+            column = geometry_t::WIDTH - 1 - y;
+            row = x;
+            break;
+        case panel_rotation_t::ROTATION_180:
+            column = geometry_t::WIDTH - 1 - x;
+            row = geometry_t::HEIGHT - 1 - y;
+            break;
+        case panel_rotation_t::ROTATION_270:
+            column = y;
+            row = geometry_t::HEIGHT - 1 - x;
+            break;
+    }
+}
+
+// Packs random areas with pack_area() and pack_area_i1() and compares them with a per pixel reference
+template <panel_rotation_t ROTATION, bool MIRROR_X, bool MIRROR_Y>
+static void verify_orientation()
+{
+    typedef panel_geometry<48, 16, ROTATION, MIRROR_X, MIRROR_Y> geometry_t;
+    const int32_t width = geometry_t::HORIZONTAL_RESOLUTION;
+    const int32_t height = geometry_t::VERTICAL_RESOLUTION;
+
+    std::vector<uint8_t> reference(geometry_t::BUFFER_SIZE, 0);
+    std::vector<uint8_t> packed(geometry_t::BUFFER_SIZE, 0);
+    std::vector<uint8_t> packed_i1(geometry_t::BUFFER_SIZE, 0);
+    bool match = true;
+
+    for (int iteration = 0; iteration < ITERATIONS && match; iteration++)
+    {
+        int32_t x1 = rand() % width;
+        int32_t x2 = x1 + rand() % (width - x1);
+        int32_t y1 = rand() % height;
+        int32_t y2 = y1 + rand() % (height - y1);
+        int32_t area_width = x2 - x1 + 1;
+        size_t stride = (area_width + 7) / 8;
+
+        std::vector<uint16_t> px_map(area_width * (y2 - y1 + 1));
+        std::vector<uint8_t> i1_map(stride * (y2 - y1 + 1), 0);
+        for (int32_t y = y1; y <= y2; y++)
+        {
+            for (int32_t x = x1; x <= x2; x++)
+            {
+                uint16_t pixel = (rand() & 1) ? static_cast<uint16_t>(rand() | 1) : 0;
+                px_map[(y - y1) * area_width + (x - x1)] = pixel;
+
+                int32_t column;
+                int32_t row;
+                reference_map<geometry_t, ROTATION, MIRROR_X, MIRROR_Y>(x, y, column, row);
+                uint8_t segment = static_cast<uint8_t>(0x80 >> (row % PIXEL_PER_BYTE));
+                uint8_t &buffer = reference[(row / PIXEL_PER_BYTE) * geometry_t::WIDTH + column];
+                buffer = pixel != 0 ? buffer | segment : buffer & ~segment;
+                if (pixel != 0)
+                {
+                    i1_map[(y - y1) * stride + (x - x1) / 8] |= 0x80 >> ((x - x1) % 8);
+                }
+            }
+        }
+
+        macdap::pack_area<geometry_t>(packed.data(), x1, y1, x2, y2, px_map.data());
+        macdap::pack_area_i1<geometry_t>(packed_i1.data(), x1, y1, x2, y2, i1_map.data(), stride);
+        match = reference == packed && reference == packed_i1;
+    }
+
+    printf("orientation %3d deg  mirror x %d  mirror y %d  %s\n",
+           90 * static_cast<int>(ROTATION), MIRROR_X, MIRROR_Y, match ? "match" : "MISMATCH");
+}
+
+// Digit register packing of a MAX7219 chain as originally done by send_buffer(), kept as the reference
+static void max_7219_bit_loop(const uint8_t *panel_buffer, int chip_nb, uint8_t *digits)
+{
+    for (int reg_digit = 0; reg_digit < 8; reg_digit++)
+    {
+        const uint8_t *columns = panel_buffer;
+        for (int chip = 0; chip < chip_nb; chip++)
+        {
+            uint8_t data = 0;
+            uint8_t segment = 0x80;
+            for (uint8_t x_bit = 0; x_bit < 8; x_bit++)
+            {
+                if (*columns & (0x80 >> reg_digit))
+                {
+                    data |= segment;
+                }
+                segment >>= 1;
+                columns++;
+            }
+            digits[reg_digit * chip_nb + chip] = data;
+        }
+    }
+}
+
+static void max_7219_transpose(const uint8_t *panel_buffer, int chip_nb, uint8_t *digits)
+{
+    for (int chip = 0; chip < chip_nb; chip++)
+    {
+        uint64_t chip_digits = macdap::columns_to_digits(panel_buffer + chip * 8);
+        for (int reg_digit = 0; reg_digit < 8; reg_digit++)
+        {
+            digits[reg_digit * chip_nb + chip] = static_cast<uint8_t>(chip_digits >> (8 * (7 - reg_digit)));
+        }
+    }
+}
+
+static void benchmark_max_7219(int chip_nb)
+{
+    std::vector<uint8_t> panel_buffer(chip_nb * 8);
+    for (auto &column : panel_buffer)
+    {
+        column = rand();
+    }
+
+    std::vector<uint8_t> reference(chip_nb * 8);
+    std::vector<uint8_t> transposed(chip_nb * 8);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < ITERATIONS * 10; iteration++)
+    {
+        max_7219_bit_loop(panel_buffer.data(), chip_nb, reference.data());
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < ITERATIONS * 10; iteration++)
+    {
+        max_7219_transpose(panel_buffer.data(), chip_nb, transposed.data());
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double before_us = std::chrono::duration<double, std::micro>(middle - start).count() / (ITERATIONS * 10);
+    double after_us = std::chrono::duration<double, std::micro>(end - middle).count() / (ITERATIONS * 10);
+
+    printf("MAX7219 %3d chips  bit loop %8.3f us/frame  transpose %8.3f us/frame  x%5.1f  %s\n",
+           chip_nb,
+           before_us,
+           after_us,
+           before_us / after_us,
+           reference == transposed ? "match" : "MISMATCH");
+}
+
+// Mock pin layer, samples DATA on every CLOCK rising edge and keeps what was shifted when LATCH rises
+typedef struct {
+    uint32_t state;
+    uint32_t clock_edges;
+    std::vector<uint8_t> shifted;
+    std::vector<uint8_t> latched;
+
+    void write(uint32_t mask, uint32_t value)
+    {
+        uint32_t previous = state;
+        state = (state & ~mask) | (value & mask);
+        if (!(previous & macdap::SHIFT_CLOCK) && (state & macdap::SHIFT_CLOCK))
+        {
+            if (clock_edges % 8 == 0)
+            {
+                shifted.push_back(0);
+            }
+            shifted.back() |= (state & macdap::SHIFT_DATA) ? 0x80 >> (clock_edges % 8) : 0;
+            clock_edges++;
+        }
+        if (!(previous & macdap::SHIFT_LATCH) && (state & macdap::SHIFT_LATCH))
+        {
+            latched = shifted;
+            shifted.clear();
+            clock_edges = 0;
+        }
+    }
+    void hold()
+    {
+    }
+} recording_pins_t;
+
+static void verify_shift_out(size_t buffer_size)
+{
+    std::vector<uint8_t> buffer(buffer_size);
+    for (auto &data : buffer)
+    {
+        data = rand();
+    }
+
+    recording_pins_t pins = {};
+    macdap::shift_out(pins, buffer.data(), buffer.size());
+
+    printf("shift_out %4zu bytes  %s\n", buffer_size, pins.latched == buffer ? "match" : "MISMATCH");
+}
+
+extern "C" void app_main(void)
+{
+    printf("LED Panel packing benchmark, %d iterations\n", ITERATIONS);
+
+    benchmark<m6_16x8_3x2_t, uint8_t>("3x2 M6_16X8");
+    benchmark<m6_16x8_3x2_t, uint16_t>("3x2 M6_16X8");
+    benchmark<m6_16x8_3x2_t, uint32_t>("3x2 M6_16X8");
+    benchmark_i1<m6_16x8_3x2_t>("3x2 M6_16X8");
+    benchmark<m4_24x8_4x1_t, uint8_t>("4x1 M4_24X8");
+    benchmark<m4_24x8_4x1_t, uint16_t>("4x1 M4_24X8");
+    benchmark<m4_24x8_4x1_t, uint32_t>("4x1 M4_24X8");
+    benchmark_i1<m4_24x8_4x1_t>("4x1 M4_24X8");
+    benchmark<max_32x8_4x1_t, uint8_t>("4x1 MAX_32X8");
+    benchmark<max_32x8_4x1_t, uint16_t>("4x1 MAX_32X8");
+    benchmark<max_32x8_4x1_t, uint32_t>("4x1 MAX_32X8");
+    benchmark_i1<max_32x8_4x1_t>("4x1 MAX_32X8");
+    benchmark<m4_24x8_10x10_t, uint8_t>("10x10 M4_24X8");
+    benchmark<m4_24x8_10x10_t, uint16_t>("10x10 M4_24X8");
+    benchmark<m4_24x8_10x10_t, uint32_t>("10x10 M4_24X8");
+    benchmark_i1<m4_24x8_10x10_t>("10x10 M4_24X8");
+
+    verify_orientation<panel_rotation_t::ROTATION_0, false, false>();
+    verify_orientation<panel_rotation_t::ROTATION_0, true, true>();
+    verify_orientation<panel_rotation_t::ROTATION_90, false, false>();
+    verify_orientation<panel_rotation_t::ROTATION_90, true, false>();
+    verify_orientation<panel_rotation_t::ROTATION_180, false, false>();
+    verify_orientation<panel_rotation_t::ROTATION_180, false, true>();
+    verify_orientation<panel_rotation_t::ROTATION_270, false, false>();
+    verify_orientation<panel_rotation_t::ROTATION_270, true, true>();
+
+    for (int chip_nb : {4, 8, 16, 40})
+    {
+        benchmark_max_7219(chip_nb);
+    }
+
+    for (size_t buffer_size : {16, 96, 320})
+    {
+        verify_shift_out(buffer_size);
+    }
+}
@@ -0,0 +1,313 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include <ledPanelPacking.hpp>
+#include <ledPanelSnapshot.hpp>
+#include <ledMatrixSnapshot.hpp>
+#include <oledDisplayPages.hpp>
+#include <oledDisplaySnapshot.hpp>
+
+#define ITERATIONS 20
+
+using macdap::panel_geometry;
+using macdap::panel_rotation_t;
+namespace snapshot = macdap::snapshot;
+namespace pages = macdap::pages;
+
+typedef panel_geometry<48, 16, panel_rotation_t::ROTATION_180> m6_16x8_3x2_t;
+typedef panel_geometry<128, 8, panel_rotation_t::ROTATION_90, true> max_32x8_4x1_t;
+
+// Reads the snapshot back, independently of the encoders
+typedef struct {
+    const uint8_t *buffer;
+    size_t length;
+    size_t position;
+    bool failed;
+} reader_t;
+
+static uint8_t get(reader_t &reader)
+{
+    if (reader.position >= reader.length)
+    {
+        reader.failed = true;
+        return 0;
+    }
+    return reader.buffer[reader.position++];
+}
+
+static uint16_t get_uint16(reader_t &reader)
+{
+    uint16_t low = get(reader);
+    return static_cast<uint16_t>(low | (get(reader) << 8));
+}
+
+static uint32_t get_varint(reader_t &reader)
+{
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35 && !reader.failed; shift += 7)
+    {
+        uint8_t byte = get(reader);
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+    reader.failed = true;
+    return 0;
+}
+
+static bool get_header(reader_t &reader, uint8_t format, uint16_t width, uint16_t height)
+{
+    bool valid = get(reader) == 'S' && get(reader) == format;
+    valid = get_uint16(reader) == width && valid;
+    return get_uint16(reader) == height && valid;
+}
+
+static bool decode_1bpp(const uint8_t *buffer, size_t length, uint16_t width, uint16_t height, std::vector<bool> &pixels)
+{
+    reader_t reader = {buffer, length, 0, false};
+    if (!get_header(reader, '1', width, height))
+    {
+        return false;
+    }
+
+    pixels.clear();
+    bool on = false;
+    while (reader.position < reader.length && !reader.failed)
+    {
+        pixels.insert(pixels.end(), get_varint(reader), on);
+        on = !on;
+    }
+    return !reader.failed && pixels.size() == static_cast<size_t>(width) * height;
+}
+
+static bool decode_rgb565(const uint8_t *buffer, size_t length, uint16_t width, uint16_t height, std::vector<uint16_t> &pixels)
+{
+    reader_t reader = {buffer, length, 0, false};
+    if (!get_header(reader, 'P', width, height))
+    {
+        return false;
+    }
+
+    std::vector<uint16_t> palette;
+    pixels.clear();
+    while (reader.position < reader.length && !reader.failed)
+    {
+        uint8_t token = get(reader);
+        uint16_t color;
+        if (token == snapshot::DEFINE)
+        {
+            color = get_uint16(reader);
+            palette.push_back(color);
+        }
+        else if (token == snapshot::LITERAL)
+        {
+            color = get_uint16(reader);
+        }
+        else if (token < palette.size())
+        {
+            color = palette[token];
+        }
+        else
+        {
+            return false;
+        }
+        pixels.insert(pixels.end(), get_varint(reader), color);
+    }
+    return !reader.failed && palette.size() <= snapshot::PALETTE_SIZE && pixels.size() == static_cast<size_t>(width) * height;
+}
+
+// Values at the boundaries of the LEB128 lengths
+static void verify_varint()
+{
+    const uint32_t values[] = {0, 1, 0x7F, 0x80, 0x3FFF, 0x4000, 0x1FFFFF, 0x200000, 0xFFFFFFF, 0x10000000, UINT32_MAX};
+    const size_t lengths[] = {1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5};
+
+    bool match = true;
+    for (size_t index = 0; index < sizeof(values) / sizeof(values[0]); index++)
+    {
+        uint8_t buffer[8];
+        snapshot::writer_t writer = {buffer, sizeof(buffer), 0};
+        snapshot::put_varint(writer, values[index]);
+
+        reader_t reader = {buffer, writer.length, 0, false};
+        match = match && writer.length == lengths[index] && get_varint(reader) == values[index] && reader.position == writer.length;
+    }
+    printf("varint               %s\n", match ? "match" : "MISMATCH");
+}
+
+// A snapshot larger than the buffer reports its whole length and writes nothing past the buffer
+static void verify_overflow(const char *name, const std::vector<uint8_t> &snapshot_data, size_t (*encode)(uint8_t *buffer, size_t size))
+{
+    const uint8_t GUARD = 0xA5;
+    bool match = true;
+    for (size_t size : {size_t(0), size_t(1), size_t(6), snapshot_data.size() / 2, snapshot_data.size() - 1})
+    {
+        std::vector<uint8_t> buffer(size + 16, GUARD);
+        size_t length = encode(buffer.data(), size);
+        match = match && length == snapshot_data.size() && std::equal(buffer.begin(), buffer.begin() + size, snapshot_data.begin());
+        for (size_t index = size; index < buffer.size(); index++)
+        {
+            match = match && buffer[index] == GUARD;
+        }
+    }
+    printf("overflow %-11s %s\n", name, match ? "match" : "MISMATCH");
+}
+
+// Bit-planes packed from random LVGL frames, a pixel being on when lit in any plane
+template <typename geometry_t>
+static void verify_panel(const char *name, uint8_t plane_nb)
+{
+    const int32_t width = geometry_t::HORIZONTAL_RESOLUTION;
+    const int32_t height = geometry_t::VERTICAL_RESOLUTION;
+
+    bool match = true;
+    size_t length = 0;
+    for (int iteration = 0; iteration < ITERATIONS && match; iteration++)
+    {
+        std::vector<uint8_t> panel_buffer(plane_nb * geometry_t::BUFFER_SIZE, 0);
+        std::vector<bool> expected(width * height, false);
+        for (uint8_t plane = 0; plane < plane_nb; plane++)
+        {
+            // Long runs as well as noise, a sparse plane on every other iteration
+            std::vector<uint8_t> px_map(width * height);
+            for (int32_t index = 0; index < width * height; index++)
+            {
+                px_map[index] = iteration % 2 ? (rand() % 16 == 0) : ((index / (1 + rand() % 8)) & 1);
+                expected[index] = expected[index] || px_map[index] != 0;
+            }
+            macdap::pack_area<geometry_t>(panel_buffer.data() + plane * geometry_t::BUFFER_SIZE, 0, 0, width - 1, height - 1, px_map.data());
+        }
+
+        std::vector<uint8_t> buffer(2 * width * height + 16);
+        length = snapshot::encode_panel<geometry_t>(panel_buffer.data(), plane_nb, buffer.data(), buffer.size());
+        std::vector<bool> pixels;
+        match = length <= buffer.size() && decode_1bpp(buffer.data(), length, width, height, pixels) && pixels == expected;
+    }
+    printf("panel %-14s %d plane%s  %5zu bytes for %5ld pixels  %s\n",
+           name, plane_nb, plane_nb > 1 ? "s" : " ", length, static_cast<long>(width * height), match ? "match" : "MISMATCH");
+}
+
+// Rows stride pixels apart, the padding holding a color that must not show up
+static void verify_matrix(const char *name, int32_t width, int32_t height, int32_t stride, uint32_t color_nb)
+{
+    std::vector<uint16_t> frame(stride * height, 0xDEAD);
+    std::vector<uint16_t> expected;
+    for (int32_t y = 0; y < height; y++)
+    {
+        for (int32_t x = 0; x < width; x++)
+        {
+            // Runs of a few pixels, colors spread over the whole RGB565 range
+            uint32_t index = (x / 3 + y * 7 + rand() % 2) % color_nb;
+            uint16_t color = static_cast<uint16_t>(index * 40503u);
+            frame[y * stride + x] = color;
+            expected.push_back(color);
+        }
+    }
+
+    std::vector<uint8_t> buffer(4 * width * height + 16);
+    size_t length = snapshot::encode_rgb565(frame.data(), width, height, stride, buffer.data(), buffer.size());
+    std::vector<uint16_t> pixels;
+    bool match = length <= buffer.size() && decode_rgb565(buffer.data(), length, width, height, pixels) && pixels == expected;
+    printf("matrix %-13s %4lu colors  %6zu bytes for %6ld pixels  %s\n",
+           name, static_cast<unsigned long>(color_nb), length, static_cast<long>(width * height), match ? "match" : "MISMATCH");
+}
+
+// Page frames packed from LVGL I1 buffers, a pixel being lit when its I1 bit is clear
+template <int32_t WIDTH, int32_t HEIGHT, bool MIRROR_X, bool MIRROR_Y>
+static void verify_pages()
+{
+    typedef pages::page_geometry<WIDTH, HEIGHT, MIRROR_X, MIRROR_Y> geometry_t;
+    const size_t stride = (WIDTH + 7) / 8;
+
+    bool match = true;
+    for (int iteration = 0; iteration < ITERATIONS && match; iteration++)
+    {
+        std::vector<uint8_t> px_map(stride * HEIGHT);
+        std::vector<bool> expected;
+        for (int32_t y = 0; y < HEIGHT; y++)
+        {
+            for (int32_t x = 0; x < WIDTH; x++)
+            {
+                bool lit = iteration % 2 ? rand() % 4 == 0 : ((x + y / 4) / 5) % 2 == 0;
+                if (!lit)
+                {
+                    px_map[y * stride + x / 8] |= static_cast<uint8_t>(0x80 >> (x % 8));
+                }
+                expected.push_back(lit);
+            }
+        }
+
+        std::vector<uint8_t> frame(geometry_t::BUFFER_SIZE, 0);
+        for (int32_t page = 0; page < HEIGHT / pages::PAGE_ROWS; page++)
+        {
+            pages::pack_page_i1<geometry_t>(frame.data() + page * WIDTH, page, 0, 0, WIDTH - 1, HEIGHT - 1, px_map.data(), stride);
+        }
+
+        std::vector<uint8_t> buffer(2 * WIDTH * HEIGHT + 16);
+        size_t length = snapshot::encode_pages<geometry_t>(frame.data(), buffer.data(), buffer.size());
+        std::vector<bool> pixels;
+        match = length <= buffer.size() && decode_1bpp(buffer.data(), length, WIDTH, HEIGHT, pixels) && pixels == expected;
+    }
+    printf("pages %3ldx%-3ld  mirror x %d  mirror y %d  %s\n", static_cast<long>(WIDTH), static_cast<long>(HEIGHT), MIRROR_X, MIRROR_Y, match ? "match" : "MISMATCH");
+}
+
+static std::vector<uint8_t> _overflow_panel;
+static std::vector<uint16_t> _overflow_frame;
+
+static size_t encode_overflow_panel(uint8_t *buffer, size_t size)
+{
+    return snapshot::encode_panel<m6_16x8_3x2_t>(_overflow_panel.data(), 1, buffer, size);
+}
+
+static size_t encode_overflow_matrix(uint8_t *buffer, size_t size)
+{
+    return snapshot::encode_rgb565(_overflow_frame.data(), 64, 32, 64, buffer, size);
+}
+
+static void verify_overflows()
+{
+    _overflow_panel.resize(m6_16x8_3x2_t::BUFFER_SIZE);
+    for (auto &byte : _overflow_panel)
+    {
+        byte = static_cast<uint8_t>(rand());
+    }
+    std::vector<uint8_t> panel_snapshot(8 * m6_16x8_3x2_t::BUFFER_SIZE);
+    panel_snapshot.resize(encode_overflow_panel(panel_snapshot.data(), panel_snapshot.size()));
+    verify_overflow("panel", panel_snapshot, encode_overflow_panel);
+
+    _overflow_frame.resize(64 * 32);
+    for (auto &pixel : _overflow_frame)
+    {
+        pixel = static_cast<uint16_t>(rand() % 300);
+    }
+    std::vector<uint8_t> matrix_snapshot(4 * _overflow_frame.size() + 16);
+    matrix_snapshot.resize(encode_overflow_matrix(matrix_snapshot.data(), matrix_snapshot.size()));
+    verify_overflow("matrix", matrix_snapshot, encode_overflow_matrix);
+}
+
+extern "C" void app_main(void)
+{
+    printf("Snapshot round trip test, %d iterations\n", ITERATIONS);
+
+    verify_varint();
+
+    verify_panel<m6_16x8_3x2_t>("3x2 M6_16X8", 1);
+    verify_panel<m6_16x8_3x2_t>("3x2 M6_16X8", 4);
+    verify_panel<max_32x8_4x1_t>("4x1 MAX_32X8", 1);
+
+    verify_matrix("64x32", 64, 32, 64, 1);
+    verify_matrix("64x32", 64, 32, 64, 16);
+    verify_matrix("64x32", 64, 32, 64, 1000);
+    verify_matrix("64x32 stride", 64, 32, 80, 300);
+    verify_matrix("128x64", 128, 64, 128, 254);
+
+    verify_pages<128, 64, false, false>();
+    verify_pages<128, 64, true, false>();
+    verify_pages<128, 32, false, true>();
+    verify_pages<72, 40, true, true>();
+
+    verify_overflows();
+}
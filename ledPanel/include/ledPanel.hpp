@@ -2,6 +2,7 @@
 
 #include "esp_err.h"
 #include "driver/spi_master.h"
+#include <esp_timer.h>
 #include <lvgl.h>
 #include <esp_lvgl_port.h>
 
@@ -15,22 +16,78 @@ namespace macdap
     } max_7219_buffer_t;
 #endif
 
+    typedef struct {
+        uint32_t flush_count;
+        uint32_t frame_count;           // A frame being one or more flushes
+        uint64_t pixels_converted;
+        uint64_t bytes_transmitted;     // With BCM grayscale, the bit-plane bytes handed to the refresh task, not the ones it keeps shifting
+        uint32_t flush_min_us;
+        uint32_t flush_avg_us;
+        uint32_t flush_max_us;
+        uint64_t bus_wait_us;           // Blocked on the panel buffer mutex or on a previous transmission
+        float fps;
+    } led_panel_stats_t;
+
     class LedPanel
     {
 
     private:
+#ifdef CONFIG_LED_PANEL_INTERFACE_SPI
+        static constexpr uint8_t TRANSMIT_BUFFER_NB = 2;
+#else
+        static constexpr uint8_t TRANSMIT_BUFFER_NB = 1;
+#endif
+#ifdef CONFIG_LED_PANEL_SPLIT_CHAIN
+        static constexpr uint8_t CHAIN_NB = 2;
+#else
+        static constexpr uint8_t CHAIN_NB = 1;
+#endif
+#ifdef CONFIG_LED_PANEL_TYPE_MAX7219
+        static constexpr uint8_t FRAME_TRANSACTION_NB = 8;  // One per digit register
+#elif CONFIG_LED_PANEL_SPLIT_CHAIN
+        static constexpr uint8_t FRAME_TRANSACTION_NB = CHAIN_NB;  // One per chain
+#else
+        static constexpr uint8_t FRAME_TRANSACTION_NB = 1;
+#endif
         lv_display_t *m_display;
         size_t m_panel_buffer_size;
         uint8_t* m_panel_buffer;
+        uint8_t m_dirty_rows;
 #ifdef CONFIG_LED_PANEL_TYPE_MAX7219
         size_t m_max_7219_buffer_len;
         max_7219_buffer_t* m_max_7219_buffer;
+        uint8_t* m_max_7219_shadow;
 #endif
+        size_t m_transmit_buffer_size;
+        uint8_t* m_transmit_buffers[TRANSMIT_BUFFER_NB];
+        uint8_t m_transmit_slot;
 #ifdef CONFIG_LED_PANEL_INTERFACE_SPI
-        spi_device_handle_t m_spi;
+        spi_device_handle_t m_spi[CHAIN_NB];
+        spi_transaction_t m_spi_transactions[TRANSMIT_BUFFER_NB][FRAME_TRANSACTION_NB];
+        uint8_t m_in_flight[TRANSMIT_BUFFER_NB];
+#endif
+#ifdef CONFIG_LED_PANEL_SPLIT_CHAIN
+        uint32_t m_chain_pending[TRANSMIT_BUFFER_NB];
+#endif
+#ifdef CONFIG_LED_PANEL_TYPE_MBI5026
+        uint8_t m_ledc_duty_resolution;
+#endif
+#ifdef CONFIG_LED_PANEL_BCM_GRAYSCALE
+        volatile uint8_t m_bcm_active_slot;
+        volatile uint8_t m_bcm_ready_slot;
+        static void bcm_task(void *arg);
 #endif
+        led_panel_stats_t m_stats;
+        uint64_t m_flush_total_us;
+        int64_t m_stats_start_us;
+        esp_timer_handle_t m_stats_timer;
         LedPanel();
         ~LedPanel();
+        static void stats_timer_callback(void *arg);
+        static void flush_cb(lv_display_t *display, const lv_area_t *area, uint8_t *px_map);
+        void transmit(void *buffer, size_t buffer_size);
+        void wait_transmit_done(uint8_t slot);
+        void wait_transmit_done();
 
     public:
         LedPanel(LedPanel const&) = delete;
@@ -46,5 +103,8 @@ namespace macdap
         void send_buffer(void *buffer, size_t buffer_size);
         void send_buffer();
         void set_intensity(float intensity);
+        led_panel_stats_t get_stats();
+        void reset_stats();
+        esp_err_t get_snapshot(uint8_t *buffer, size_t size, size_t *length);
     };
 }
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+// Packing of LVGL pixels into the 1 bit panel layout.
+// The panel buffer holds one byte per physical column for each band of 8 physical rows, the MSB being the first row of the band.
+// How LVGL coordinates land on the physical panel is a compile time geometry policy, so all the index math constant-folds.
+// Plain C++, examples/benchmark builds it for the linux target.
+
+namespace macdap
+{
+    enum class panel_rotation_t {
+        ROTATION_0,
+        ROTATION_90,
+        ROTATION_180,
+        ROTATION_270
+    };
+
+    // PHYSICAL_WIDTH x PHYSICAL_HEIGHT is the panel as wired, the content being rotated clockwise by ROTATION
+    // after being mirrored by MIRROR_X and MIRROR_Y.
+    template <int32_t PHYSICAL_WIDTH, int32_t PHYSICAL_HEIGHT, panel_rotation_t ROTATION, bool MIRROR_X = false, bool MIRROR_Y = false>
+    struct panel_geometry
+    {
+        static_assert(PHYSICAL_WIDTH > 0 && PHYSICAL_HEIGHT > 0 && PHYSICAL_HEIGHT % 8 == 0, "Panel height must be a multiple of 8 rows");
+
+        static constexpr int32_t WIDTH = PHYSICAL_WIDTH;
+        static constexpr int32_t HEIGHT = PHYSICAL_HEIGHT;
+        static constexpr size_t BUFFER_SIZE = (PHYSICAL_HEIGHT / 8) * PHYSICAL_WIDTH;
+
+        // Physical columns come from logical rows, and physical rows from logical columns
+        static constexpr bool SWAP_XY = ROTATION == panel_rotation_t::ROTATION_90 || ROTATION == panel_rotation_t::ROTATION_270;
+        static constexpr bool REVERSE_COLUMNS = SWAP_XY ? (ROTATION == panel_rotation_t::ROTATION_90) != MIRROR_Y : (ROTATION == panel_rotation_t::ROTATION_180) != MIRROR_X;
+        static constexpr bool REVERSE_ROWS = SWAP_XY ? (ROTATION == panel_rotation_t::ROTATION_270) != MIRROR_X : (ROTATION == panel_rotation_t::ROTATION_180) != MIRROR_Y;
+
+        // Resolution as seen by LVGL
+        static constexpr int32_t HORIZONTAL_RESOLUTION = SWAP_XY ? PHYSICAL_HEIGHT : PHYSICAL_WIDTH;
+        static constexpr int32_t VERTICAL_RESOLUTION = SWAP_XY ? PHYSICAL_WIDTH : PHYSICAL_HEIGHT;
+
+        static constexpr int32_t column(int32_t x, int32_t y)
+        {
+            return REVERSE_COLUMNS ? PHYSICAL_WIDTH - 1 - (SWAP_XY ? y : x) : (SWAP_XY ? y : x);
+        }
+
+        static constexpr int32_t row(int32_t x, int32_t y)
+        {
+            return REVERSE_ROWS ? PHYSICAL_HEIGHT - 1 - (SWAP_XY ? x : y) : (SWAP_XY ? x : y);
+        }
+
+        static constexpr size_t index(int32_t x, int32_t y)
+        {
+            return (row(x, y) / 8) * PHYSICAL_WIDTH + column(x, y);
+        }
+
+        static constexpr uint8_t bit(int32_t x, int32_t y)
+        {
+            return static_cast<uint8_t>(0x80 >> (row(x, y) % 8));
+        }
+    };
+
+    namespace packing
+    {
+        static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Lane extraction assumes a little endian target");
+
+        static constexpr int32_t ROWS_PER_BAND = 8;
+
+        // Pixels are tested 32 bits at a time, each pixel being a lane of the word
+        template <typename pixel_t>
+        struct lanes
+        {
+            static constexpr int32_t PER_WORD = sizeof(uint32_t) / sizeof(pixel_t);
+            static constexpr int32_t BITS = 8 * sizeof(pixel_t);
+            static constexpr uint32_t LOW = sizeof(pixel_t) == 1 ? 0x7F7F7F7F : sizeof(pixel_t) == 2 ? 0x7FFF7FFF : 0x7FFFFFFF;
+
+            // Sets the top bit of every lane holding a non zero pixel
+            static inline uint32_t non_zero(uint32_t word)
+            {
+                return (((word & LOW) + LOW) | word) & ~LOW;
+            }
+        };
+
+        static inline uint32_t load_word(const uint8_t *src)
+        {
+            uint32_t word;
+            memcpy(&word, src, sizeof(word));
+            return word;
+        }
+
+        // Transposes an 8x8 bit matrix, row i being held in byte (7 - i) of the word with column 0 as its MSB.
+        // Afterwards byte (7 - j) holds column j, its MSB coming from row 0.
+        static inline uint64_t transpose8x8(uint64_t matrix)
+        {
+            uint64_t t;
+            t = (matrix ^ (matrix >> 7)) & 0x00AA00AA00AA00AAULL;
+            matrix = matrix ^ t ^ (t << 7);
+            t = (matrix ^ (matrix >> 14)) & 0x0000CCCC0000CCCCULL;
+            matrix = matrix ^ t ^ (t << 14);
+            t = (matrix ^ (matrix >> 28)) & 0x00000000F0F0F0F0ULL;
+            matrix = matrix ^ t ^ (t << 28);
+            return matrix;
+        }
+
+        // 8 bit brightness of a pixel, for L8, RGB565 and XRGB8888
+        static inline uint8_t luminance(uint8_t pixel)
+        {
+            return pixel;
+        }
+
+        static inline uint8_t luminance(uint16_t pixel)
+        {
+            uint32_t red = (pixel >> 11) << 3;
+            uint32_t green = ((pixel >> 5) & 0x3F) << 2;
+            uint32_t blue = (pixel & 0x1F) << 3;
+            return static_cast<uint8_t>((red * 77 + green * 150 + blue * 29) >> 8);
+        }
+
+        static inline uint8_t luminance(uint32_t pixel)
+        {
+            uint32_t red = (pixel >> 16) & 0xFF;
+            uint32_t green = (pixel >> 8) & 0xFF;
+            uint32_t blue = pixel & 0xFF;
+            return static_cast<uint8_t>((red * 77 + green * 150 + blue * 29) >> 8);
+        }
+
+        static inline uint8_t merge(uint8_t *destination, uint8_t mask, uint8_t bits)
+        {
+            uint8_t previous = *destination;
+            uint8_t current = (previous & ~mask) | bits;
+            *destination = current;
+            return previous ^ current;
+        }
+
+        // Logical rows y..end of an unswapped geometry share a band of the panel buffer,
+        // logical row y + r being bit 0x80 >> (row_bit + ROW_STEP * r) of that band
+        template <typename geometry_t>
+        struct band_segment
+        {
+            static constexpr int32_t ROW_STEP = geometry_t::REVERSE_ROWS ? -1 : 1;
+            static constexpr int32_t COLUMN_STEP = geometry_t::REVERSE_COLUMNS ? -1 : 1;
+
+            int32_t band;
+            int32_t row_bit;
+            int32_t rows;
+            int32_t end;
+            uint8_t mask;
+
+            band_segment(int32_t y, int32_t y2)
+            {
+                const int32_t row = geometry_t::row(0, y);
+                band = row / ROWS_PER_BAND;
+                row_bit = row % ROWS_PER_BAND;
+                const int32_t band_end = geometry_t::REVERSE_ROWS ? geometry_t::HEIGHT - 1 - band * ROWS_PER_BAND : band * ROWS_PER_BAND + ROWS_PER_BAND - 1;
+                end = band_end < y2 ? band_end : y2;
+                rows = end - y + 1;
+                const int32_t top_row = geometry_t::REVERSE_ROWS ? row_bit - rows + 1 : row_bit;
+                mask = static_cast<uint8_t>(((1 << rows) - 1) << (ROWS_PER_BAND - top_row - rows));
+            }
+
+            // Panel buffer byte of the first column of the segment
+            uint8_t *destination(uint8_t *panel_buffer, int32_t x1) const
+            {
+                return panel_buffer + band * geometry_t::WIDTH + geometry_t::column(x1, 0);
+            }
+        };
+
+        template <typename geometry_t>
+        static inline void assert_area(int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+        {
+            assert(x1 >= 0 && x2 < geometry_t::HORIZONTAL_RESOLUTION && x1 <= x2);
+            assert(y1 >= 0 && y2 < geometry_t::VERTICAL_RESOLUTION && y1 <= y2);
+        }
+    }
+
+    // Packs the area x1..x2, y1..y2 of px_map into the panel buffer.
+    // Returns the bits that changed, OR'ed together, a set bit is a row (within a band) that must be re-transmitted.
+    template <typename geometry_t, typename pixel_t>
+    uint8_t pack_area(uint8_t *panel_buffer, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const pixel_t *px_map)
+    {
+        using namespace packing;
+        typedef lanes<pixel_t> lane_t;
+        typedef band_segment<geometry_t> segment_t;
+
+        assert_area<geometry_t>(x1, y1, x2, y2);
+
+        const int32_t width = x2 - x1 + 1;
+        uint8_t changed = 0;
+
+        if constexpr (geometry_t::SWAP_XY)
+        {
+            // Logical rows run along physical columns, pixels are placed one at a time
+            for (int32_t y = y1; y <= y2; y++)
+            {
+                for (int32_t x = x1; x <= x2; x++)
+                {
+                    const uint8_t bit = geometry_t::bit(x, y);
+                    changed |= merge(panel_buffer + geometry_t::index(x, y), bit, *px_map != 0 ? bit : 0);
+                    px_map++;
+                }
+            }
+            return changed;
+        }
+
+        const size_t row_bytes = width * sizeof(pixel_t);
+        const uint8_t *source = reinterpret_cast<const uint8_t *>(px_map);
+
+        int32_t y = y1;
+        while (y <= y2)
+        {
+            const segment_t segment(y, y2);
+            const uint8_t *segment_source = source + (y - y1) * row_bytes;
+            uint8_t *destination = segment.destination(panel_buffer, x1);
+
+            // Whole words, then fewer than a word of columns, a bound the compiler can see through
+            const int32_t tail_columns = width % lane_t::PER_WORD;
+            const int32_t word_columns = width - tail_columns;
+            for (int32_t column = 0; column < word_columns; column += lane_t::PER_WORD)
+            {
+                uint32_t accumulator = 0;
+                const uint8_t *word = segment_source + column * sizeof(pixel_t);
+                for (int32_t row = 0; row < segment.rows; row++)
+                {
+                    accumulator |= lane_t::non_zero(load_word(word)) >> (lane_t::BITS - ROWS_PER_BAND + segment.row_bit + segment_t::ROW_STEP * row);
+                    word += row_bytes;
+                }
+                for (int32_t lane = 0; lane < lane_t::PER_WORD; lane++)
+                {
+                    changed |= merge(destination + segment_t::COLUMN_STEP * (column + lane), segment.mask, static_cast<uint8_t>(accumulator >> (lane * lane_t::BITS)));
+                }
+            }
+
+            for (int32_t tail = 0; tail < tail_columns; tail++)
+            {
+                const int32_t column = word_columns + tail;
+                uint8_t bits = 0;
+                const pixel_t *pixel = px_map + (y - y1) * width + column;
+                for (int32_t row = 0; row < segment.rows; row++)
+                {
+                    if (*pixel != 0)
+                    {
+                        bits |= 0x80 >> (segment.row_bit + segment_t::ROW_STEP * row);
+                    }
+                    pixel += width;
+                }
+                changed |= merge(destination + segment_t::COLUMN_STEP * column, segment.mask, bits);
+            }
+
+            y = segment.end + 1;
+        }
+
+        return changed;
+    }
+
+    // Packs the area x1..x2, y1..y2 of px_map into plane_nb bit-planes stored back to back in the panel buffer,
+    // plane n holding bit n of each pixel's brightness quantized to plane_nb bits (at most 8).
+    // Returns the bits that changed in any plane, as for pack_area().
+    template <typename geometry_t, typename pixel_t>
+    uint8_t pack_area_planes(uint8_t *panel_buffer, int32_t plane_nb, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const pixel_t *px_map)
+    {
+        using namespace packing;
+        typedef band_segment<geometry_t> segment_t;
+
+        assert(plane_nb > 0 && plane_nb <= 8);
+        assert_area<geometry_t>(x1, y1, x2, y2);
+
+        const int32_t width = x2 - x1 + 1;
+        uint8_t changed = 0;
+
+        if constexpr (geometry_t::SWAP_XY)
+        {
+            for (int32_t y = y1; y <= y2; y++)
+            {
+                for (int32_t x = x1; x <= x2; x++)
+                {
+                    const uint8_t bit = geometry_t::bit(x, y);
+                    const uint8_t level = luminance(*px_map) >> (8 - plane_nb);
+                    for (int32_t plane = 0; plane < plane_nb; plane++)
+                    {
+                        changed |= merge(panel_buffer + plane * geometry_t::BUFFER_SIZE + geometry_t::index(x, y), bit, (level & (1 << plane)) ? bit : 0);
+                    }
+                    px_map++;
+                }
+            }
+            return changed;
+        }
+
+        int32_t y = y1;
+        while (y <= y2)
+        {
+            const segment_t segment(y, y2);
+            uint8_t *destination = segment.destination(panel_buffer, x1);
+
+            for (int32_t column = 0; column < width; column++)
+            {
+                uint8_t bits[8] = {};
+                const pixel_t *pixel = px_map + (y - y1) * width + column;
+                for (int32_t row = 0; row < segment.rows; row++)
+                {
+                    uint8_t level = luminance(*pixel) >> (8 - plane_nb);
+                    for (int32_t plane = 0; plane < plane_nb; plane++)
+                    {
+                        if (level & (1 << plane))
+                        {
+                            bits[plane] |= 0x80 >> (segment.row_bit + segment_t::ROW_STEP * row);
+                        }
+                    }
+                    pixel += width;
+                }
+                for (int32_t plane = 0; plane < plane_nb; plane++)
+                {
+                    changed |= merge(destination + plane * geometry_t::BUFFER_SIZE + segment_t::COLUMN_STEP * column, segment.mask, bits[plane]);
+                }
+            }
+
+            y = segment.end + 1;
+        }
+
+        return changed;
+    }
+
+    // Turns the 8 column bytes of a MAX7219 module into its 8 digit registers in one pass.
+    // Digit d is byte (7 - d) of the result, its MSB coming from the first column.
+    static inline uint64_t columns_to_digits(const uint8_t *columns)
+    {
+        uint64_t matrix;
+        memcpy(&matrix, columns, sizeof(matrix));
+        return packing::transpose8x8(__builtin_bswap64(matrix));
+    }
+
+    // Packs the area x1..x2, y1..y2 of an LVGL I1 buffer (palette already skipped) into the panel buffer.
+    // Rows are stride bytes apart, 8 pixels per byte MSB first, so 8 columns of a band are packed with one transpose.
+    // Returns the bits that changed, as for pack_area().
+    template <typename geometry_t>
+    uint8_t pack_area_i1(uint8_t *panel_buffer, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const uint8_t *px_map, size_t stride)
+    {
+        using namespace packing;
+        typedef band_segment<geometry_t> segment_t;
+
+        assert_area<geometry_t>(x1, y1, x2, y2);
+
+        const int32_t width = x2 - x1 + 1;
+        uint8_t changed = 0;
+
+        if constexpr (geometry_t::SWAP_XY)
+        {
+            for (int32_t y = y1; y <= y2; y++)
+            {
+                const uint8_t *source = px_map + (y - y1) * stride;
+                for (int32_t column = 0; column < width; column++)
+                {
+                    const uint8_t bit = geometry_t::bit(x1 + column, y);
+                    const bool on = source[column / 8] & (0x80 >> (column % 8));
+                    changed |= merge(panel_buffer + geometry_t::index(x1 + column, y), bit, on ? bit : 0);
+                }
+            }
+            return changed;
+        }
+
+        int32_t y = y1;
+        while (y <= y2)
+        {
+            const segment_t segment(y, y2);
+            const uint8_t *segment_source = px_map + (y - y1) * stride;
+            uint8_t *destination = segment.destination(panel_buffer, x1);
+
+            for (int32_t column = 0; column < width; column += ROWS_PER_BAND)
+            {
+                // Row r of the segment goes to matrix row (row_bit + ROW_STEP * r) so that it ends up as that bit of the band
+                uint64_t matrix = 0;
+                const uint8_t *source = segment_source + column / ROWS_PER_BAND;
+                for (int32_t row = 0; row < segment.rows; row++)
+                {
+                    matrix |= static_cast<uint64_t>(*source) << (8 * (ROWS_PER_BAND - 1 - segment.row_bit - segment_t::ROW_STEP * row));
+                    source += stride;
+                }
+                matrix = transpose8x8(matrix);
+
+                const int32_t columns = width - column < ROWS_PER_BAND ? width - column : ROWS_PER_BAND;
+                for (int32_t lane = 0; lane < columns; lane++)
+                {
+                    changed |= merge(destination + segment_t::COLUMN_STEP * (column + lane), segment.mask, static_cast<uint8_t>(matrix >> (8 * (ROWS_PER_BAND - 1 - lane))));
+                }
+            }
+
+            y = segment.end + 1;
+        }
+
+        return changed;
+    }
+}
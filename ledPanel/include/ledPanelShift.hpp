@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Bit banged shift out of a buffer, independent of how the pins are driven.
+// pins_t provides write(mask, value), setting the SHIFT_* signals selected by mask, and hold(),
+// called after every clock edge to respect the shift register timing.
+// A recording pins_t lets the produced bit stream be verified on the host.
+
+namespace macdap
+{
+    static constexpr uint32_t SHIFT_DATA = 1 << 0;
+    static constexpr uint32_t SHIFT_CLOCK = 1 << 1;
+    static constexpr uint32_t SHIFT_LATCH = 1 << 2;
+
+    // Shifts buffer MSB first, data changing while the clock is low, then raises the latch
+    template <typename pins_t>
+    void shift_out(pins_t &pins, const uint8_t *buffer, size_t buffer_size)
+    {
+        pins.write(SHIFT_LATCH | SHIFT_CLOCK, 0);
+        for (size_t index = 0; index < buffer_size; index++)
+        {
+            uint8_t data = buffer[index];
+            for (int bit = 0; bit < 8; bit++)
+            {
+                pins.write(SHIFT_CLOCK | SHIFT_DATA, (data & 0x80) ? SHIFT_DATA : 0);
+                pins.hold();
+                pins.write(SHIFT_CLOCK, SHIFT_CLOCK);
+                pins.hold();
+                data = data << 1;
+            }
+        }
+        pins.write(SHIFT_CLOCK, 0);
+        pins.write(SHIFT_LATCH, SHIFT_LATCH);
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <snapshot.hpp>
+
+// Snapshot of a panel buffer, in the '1' format of snapshot.hpp.
+
+namespace macdap
+{
+    namespace snapshot
+    {
+        // Pixels of a panel buffer, a BCM buffer holding plane_nb planes of geometry_t::BUFFER_SIZE bytes, a pixel being on when lit in any plane
+        template <typename geometry_t>
+        static inline size_t encode_panel(const uint8_t *panel_buffer, uint8_t plane_nb, uint8_t *buffer, size_t size)
+        {
+            return encode_1bpp(geometry_t::HORIZONTAL_RESOLUTION, geometry_t::VERTICAL_RESOLUTION,
+                [panel_buffer, plane_nb](int32_t x, int32_t y) {
+                    const size_t index = geometry_t::index(x, y);
+                    const uint8_t bit = geometry_t::bit(x, y);
+                    for (uint8_t plane = 0; plane < plane_nb; plane++)
+                    {
+                        if (panel_buffer[plane * geometry_t::BUFFER_SIZE + index] & bit)
+                        {
+                            return true;
+                        }
+                    }
+                    return false;
+                }, buffer, size);
+        }
+    }
+}
@@ -1,11 +1,26 @@
 #include <ledPanel.hpp>
+#include <ledPanelPacking.hpp>
+#include <ledPanelShift.hpp>
+#include <ledPanelSnapshot.hpp>
 #include <string.h>
 #include <cmath>
 #include <esp_log.h>
 #include <esp_check.h>
 #include <driver/ledc.h>
-// #include <esp_timer.h>
+#include <esp_timer.h>
 #include "esp_heap_caps.h"
+#ifdef CONFIG_LED_PANEL_BCM_GRAYSCALE
+#include <driver/gptimer.h>
+#include <soc/soc.h>
+#endif
+#ifdef CONFIG_LED_PANEL_SPLIT_CHAIN
+#include <hal/gpio_ll.h>
+#endif
+#ifdef CONFIG_LED_PANEL_INTERFACE_GPIO_DEDICATED
+#include <esp_cpu.h>
+#include <driver/dedic_gpio.h>
+#include <hal/dedic_gpio_cpu_ll.h>
+#endif
 
 // #include <string.h>
 // #include <esp_timer.h>
@@ -18,7 +33,7 @@ using namespace macdap;
 #define HIGH 1
 static const char *TAG = "ledPanel (GPIO)";
 #elif CONFIG_LED_PANEL_INTERFACE_SPI
-#define SPI_QUEUE_SIZE 10
+#define SPI_QUEUE_SIZE (TRANSMIT_BUFFER_NB * FRAME_TRANSACTION_NB)
 static const char *TAG = "ledPanel (SPI)";
 #endif
 
@@ -26,6 +41,7 @@ static const char *TAG = "ledPanel (SPI)";
 #define ALL_DIGITS       8
 #define ALL_BITS         8
 #define MAX_INTENSITY    15
+#define REG_NO_OP        (0x00)
 #define REG_DIGIT_0      (0x01)
 #define REG_DECODE_MODE  (0x09)
 #define REG_INTENSITY    (0x0A)
@@ -36,7 +52,9 @@ static const char *TAG = "ledPanel (SPI)";
 
 #define PIXEL_PER_BYTE 8
 
-#if LV_COLOR_DEPTH == 32
+#ifdef CONFIG_LED_PANEL_COLOR_FORMAT_I1
+#define I1_PALETTE_SIZE (LV_COLOR_INDEXED_PALETTE_SIZE(LV_COLOR_FORMAT_I1) * sizeof(lv_color32_t))
+#elif LV_COLOR_DEPTH == 32
 #define BYTES_PER_PIXEL 4
 #elif LV_COLOR_DEPTH == 16
 #define BYTES_PER_PIXEL 2
@@ -46,37 +64,92 @@ static const char *TAG = "ledPanel (SPI)";
 #error "Unsupported LV_COLOR_DEPTH"
 #endif
 
+#if defined(CONFIG_LED_PANEL_ROTATION_0)
+#define PANEL_ROTATION panel_rotation_t::ROTATION_0
+#elif defined(CONFIG_LED_PANEL_ROTATION_90)
+#define PANEL_ROTATION panel_rotation_t::ROTATION_90
+#elif defined(CONFIG_LED_PANEL_ROTATION_270)
+#define PANEL_ROTATION panel_rotation_t::ROTATION_270
+#else
+#define PANEL_ROTATION panel_rotation_t::ROTATION_180
+#endif
+
+#ifdef CONFIG_LED_PANEL_MIRROR_X
+#define PANEL_MIRROR_X true
+#else
+#define PANEL_MIRROR_X false
+#endif
+#ifdef CONFIG_LED_PANEL_MIRROR_Y
+#define PANEL_MIRROR_Y true
+#else
+#define PANEL_MIRROR_Y false
+#endif
+
+typedef panel_geometry<CONFIG_LED_PANEL_MODULE_WIDTH * CONFIG_LED_PANEL_MATRIX_WIDTH,
+                       CONFIG_LED_PANEL_MODULE_HEIGHT * CONFIG_LED_PANEL_MATRIX_HEIGHT,
+                       PANEL_ROTATION, PANEL_MIRROR_X, PANEL_MIRROR_Y> geometry_t;
+
 static SemaphoreHandle_t _panel_buffer_mutex;
 
-static void set_pixel(LedPanel* ledPanel, int32_t horizontal_resolution, int32_t vertical_resolution, int32_t x, int32_t y, bool state)
-{
-    if (x < 0 || x >= horizontal_resolution || y < 0 || y >= vertical_resolution)
-    {
-        ESP_LOGE(TAG, "set_pixel x=%ld, y=%ld out of bounds", x, y);
-        return;
-    }
+#ifdef CONFIG_LED_PANEL_BCM_GRAYSCALE
+#define BCM_TIMER_RESOLUTION_HZ (1000000)
+#define BCM_LEDC_PERIODS_PER_BASE (16)
 
-    int16_t x_reverse = horizontal_resolution - 1 - x;
-    int16_t y_reverse = vertical_resolution - 1 - y;
+static TaskHandle_t _bcm_task_handle;
+static gptimer_handle_t _bcm_timer;
+static volatile uint8_t _bcm_plane;
+static uint32_t _bcm_base_us;
 
-    uint16_t buffer_index = (y_reverse / PIXEL_PER_BYTE) * horizontal_resolution + x_reverse;
-    uint8_t segment = static_cast<uint8_t>(0x80 >> (y_reverse % PIXEL_PER_BYTE));
-    uint8_t buffer = ledPanel->get_buffer(buffer_index);
+// The refresh task owns the SPI device, send_buffer() borrows it through the bus mutex,
+// wanted keeping the task from taking the mutex back before the borrower got it
+static SemaphoreHandle_t _bcm_bus_mutex;
+static volatile bool _bcm_bus_wanted;
+static volatile bool _bcm_stop;
+static SemaphoreHandle_t _bcm_stopped;
+#endif
 
-    if (state)
-    {
-        buffer = buffer | segment;
-    }
-    else
+#ifdef CONFIG_LED_PANEL_INTERFACE_SPI
+// Chain 0 feeds the modules nearest to the controller, it shifts the end of the frame
+static const spi_host_device_t _chain_hosts[] = {SPI3_HOST, SPI2_HOST};
+static const int _chain_data[] = {CONFIG_LED_PANEL_DATA,
+#ifdef CONFIG_LED_PANEL_SPLIT_CHAIN
+    CONFIG_LED_PANEL_DATA2
+#endif
+};
+static const int _chain_clock[] = {CONFIG_LED_PANEL_CLOCK,
+#ifdef CONFIG_LED_PANEL_SPLIT_CHAIN
+    CONFIG_LED_PANEL_CLOCK2
+#endif
+};
+#endif
+
+#ifdef CONFIG_LED_PANEL_SPLIT_CHAIN
+// Called from the SPI ISR of either host, the last chain to finish shifting a frame latches it
+static void IRAM_ATTR chain_done_cb(spi_transaction_t *spi_transaction)
+{
+    uint32_t *chain_pending = static_cast<uint32_t*>(spi_transaction->user);
+    if (chain_pending != nullptr && __atomic_sub_fetch(chain_pending, 1, __ATOMIC_ACQ_REL) == 0)
     {
-        buffer = buffer & ~segment;
+        gpio_ll_set_level(GPIO_LL_GET_HW(GPIO_PORT_0), CONFIG_LED_PANEL_LATCH, 1);
     }
-    ledPanel->set_buffer(buffer_index, buffer);
 }
+#endif
+
+#ifdef CONFIG_LED_PANEL_INTERFACE_GPIO_DEDICATED
+#define HOLD_CYCLES (CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000 / (2 * CONFIG_LED_PANEL_INTERFACE_GPIO_CLOCK_SPEED))
+
+static dedic_gpio_bundle_handle_t _bundle;
+static uint32_t _bundle_offset;
+static int _bundle_core;
+#endif
 
-static void flush_cb(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+void LedPanel::flush_cb(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
 {
-#if BYTES_PER_PIXEL == 1
+#ifdef CONFIG_LED_PANEL_COLOR_FORMAT_I1
+    // LVGL places the palette ahead of the indexed pixels
+    uint8_t *local_px_map = px_map + I1_PALETTE_SIZE;
+    uint32_t stride = lv_draw_buf_width_to_stride(lv_area_get_width(area), LV_COLOR_FORMAT_I1);
+#elif BYTES_PER_PIXEL == 1
     uint8_t *local_px_map = px_map;
 #elif BYTES_PER_PIXEL == 2
     uint16_t *local_px_map = (uint16_t *)px_map;
@@ -88,25 +161,120 @@ static void flush_cb(lv_display_t *display, const lv_area_t *area, uint8_t *px_m
 
     LedPanel* ledPanel = static_cast<LedPanel*>(lv_display_get_user_data(display));
 
+    int64_t flush_start_us = esp_timer_get_time();
     xSemaphoreTake(_panel_buffer_mutex, portMAX_DELAY);
+    ledPanel->m_stats.bus_wait_us += esp_timer_get_time() - flush_start_us;
 
-    int32_t horizontal_resolution = lv_display_get_horizontal_resolution(display);
-    int32_t vertical_resolution = lv_display_get_vertical_resolution(display);
+    // Each bit set in m_dirty_rows is a row (within an 8 rows band) that changed since the last transmission
+#ifdef CONFIG_LED_PANEL_BCM_GRAYSCALE
+    ledPanel->m_dirty_rows |= pack_area_planes<geometry_t>(ledPanel->m_panel_buffer, CONFIG_LED_PANEL_BCM_BIT_DEPTH, area->x1, area->y1, area->x2, area->y2, local_px_map);
+#elif CONFIG_LED_PANEL_COLOR_FORMAT_I1
+    ledPanel->m_dirty_rows |= pack_area_i1<geometry_t>(ledPanel->m_panel_buffer, area->x1, area->y1, area->x2, area->y2, local_px_map, stride);
+#else
+    ledPanel->m_dirty_rows |= pack_area<geometry_t>(ledPanel->m_panel_buffer, area->x1, area->y1, area->x2, area->y2, local_px_map);
+#endif
 
-    int32_t x, y;
-    for(y = area->y1; y <= area->y2; y++) {
-        for(x = area->x1; x <= area->x2; x++) {
-            set_pixel(ledPanel, horizontal_resolution, vertical_resolution, x, y, *local_px_map != 0);
-            local_px_map++;
-        }
+    // In partial render mode a refresh is split in several areas, transmit once all of them are packed
+    if (lv_display_flush_is_last(display))
+    {
+        ledPanel->send_buffer();
+        ledPanel->m_stats.frame_count++;
     }
 
-    ledPanel->send_buffer();
+    uint32_t flush_us = static_cast<uint32_t>(esp_timer_get_time() - flush_start_us);
+    ledPanel->m_stats.flush_count++;
+    ledPanel->m_stats.pixels_converted += lv_area_get_size(area);
+    ledPanel->m_flush_total_us += flush_us;
+    if (flush_us < ledPanel->m_stats.flush_min_us)
+    {
+        ledPanel->m_stats.flush_min_us = flush_us;
+    }
+    if (flush_us > ledPanel->m_stats.flush_max_us)
+    {
+        ledPanel->m_stats.flush_max_us = flush_us;
+    }
 
+    xSemaphoreGive(_panel_buffer_mutex);
+
+    // px_map is no longer referenced, the transmission works from the driver's own buffers,
+    // so LVGL can render the next frame while this one is still being clocked out
     lv_disp_flush_ready(display);
+}
 
-    xSemaphoreGive(_panel_buffer_mutex);
+#ifdef CONFIG_LED_PANEL_BCM_GRAYSCALE
+// Moves on to the next bit-plane and schedules the one after it, plane n being shown for 2^n base on-times
+static bool IRAM_ATTR bcm_alarm_cb(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t high_task_awoken = pdFALSE;
+
+    uint8_t plane = (_bcm_plane + 1) % CONFIG_LED_PANEL_BCM_BIT_DEPTH;
+    _bcm_plane = plane;
+
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = edata->alarm_value + (static_cast<uint64_t>(_bcm_base_us) << plane),
+        .reload_count = 0,
+        .flags = {
+            .auto_reload_on_alarm = false
+        }
+    };
+    gptimer_set_alarm_action(timer, &alarm_config);
+
+    vTaskNotifyGiveFromISR(_bcm_task_handle, &high_task_awoken);
+    return high_task_awoken == pdTRUE;
+}
+
+// A bit-plane latches when its transaction ends, one base on-time or more after it was queued,
+// so each plane stays displayed for exactly its own alarm period
+void LedPanel::bcm_task(void *arg)
+{
+    LedPanel *ledPanel = static_cast<LedPanel*>(arg);
+    spi_transaction_t spi_transaction = {};
+    spi_transaction_t *done_transaction;
+    bool in_flight = false;
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint8_t plane = _bcm_plane;
+
+        if (in_flight)
+        {
+            ESP_ERROR_CHECK(spi_device_get_trans_result(ledPanel->m_spi[0], &done_transaction, portMAX_DELAY));
+            in_flight = false;
+            xSemaphoreGive(_bcm_bus_mutex);
+        }
+
+        if (_bcm_stop)
+        {
+            break;
+        }
+
+        // While send_buffer() has the bus the previous bit-plane stays latched, this subframe is skipped
+        if (_bcm_bus_wanted || xSemaphoreTake(_bcm_bus_mutex, 0) != pdTRUE)
+        {
+            continue;
+        }
+
+        // A new frame is only picked up between cycles, never while send_buffer() is writing it
+        if (plane == 0 && xSemaphoreTake(_panel_buffer_mutex, 0) == pdTRUE)
+        {
+            ledPanel->m_bcm_active_slot = ledPanel->m_bcm_ready_slot;
+            xSemaphoreGive(_panel_buffer_mutex);
+        }
+
+        spi_transaction = {};
+        spi_transaction.length = ledPanel->m_panel_buffer_size * PIXEL_PER_BYTE;
+        spi_transaction.tx_buffer = ledPanel->m_transmit_buffers[ledPanel->m_bcm_active_slot] + plane * ledPanel->m_panel_buffer_size;
+        spi_transaction.rx_buffer = nullptr;
+        ESP_ERROR_CHECK(spi_device_queue_trans(ledPanel->m_spi[0], &spi_transaction, portMAX_DELAY));
+        in_flight = true;
+    }
+
+    // Nothing is left queued from this stack, the destructor can release the device
+    xSemaphoreGive(_bcm_stopped);
+    vTaskDelete(nullptr);
 }
+#endif
 
 LedPanel::LedPanel()
 {
@@ -119,7 +287,28 @@ LedPanel::LedPanel()
         return;
     }
 
-#ifdef CONFIG_LED_PANEL_INTERFACE_GPIO
+#ifdef CONFIG_LED_PANEL_INTERFACE_GPIO_DEDICATED
+    const int bundle_gpios[] = {CONFIG_LED_PANEL_DATA, CONFIG_LED_PANEL_CLOCK, CONFIG_LED_PANEL_LATCH};
+    for (int gpio : bundle_gpios)
+    {
+        gpio_reset_pin(static_cast<gpio_num_t>(gpio));
+        gpio_set_direction(static_cast<gpio_num_t>(gpio), GPIO_MODE_OUTPUT);
+    }
+    dedic_gpio_bundle_config_t bundle_config = {
+        .gpio_array = bundle_gpios,
+        .array_size = sizeof(bundle_gpios) / sizeof(bundle_gpios[0]),
+        .flags = {
+            .in_en = 0,
+            .in_invert = 0,
+            .out_en = 1,
+            .out_invert = 0
+        }
+    };
+    ESP_ERROR_CHECK(dedic_gpio_new_bundle(&bundle_config, &_bundle));
+    ESP_ERROR_CHECK(dedic_gpio_get_out_offset(_bundle, &_bundle_offset));
+    _bundle_core = esp_cpu_get_core_id();
+    dedic_gpio_bundle_write(_bundle, SHIFT_DATA | SHIFT_CLOCK | SHIFT_LATCH, 0);
+#elif CONFIG_LED_PANEL_INTERFACE_GPIO
     gpio_reset_pin(static_cast<gpio_num_t>(CONFIG_LED_PANEL_DATA));
     gpio_set_direction(static_cast<gpio_num_t>(CONFIG_LED_PANEL_DATA), GPIO_MODE_OUTPUT);
     gpio_set_level(static_cast<gpio_num_t>(CONFIG_LED_PANEL_DATA), LOW);
@@ -128,71 +317,137 @@ LedPanel::LedPanel()
     gpio_set_level(static_cast<gpio_num_t>(CONFIG_LED_PANEL_CLOCK), LOW);
 #endif
 #ifdef CONFIG_LED_PANEL_INTERFACE_SPI
-    spi_bus_config_t spi_bus_config = {
-        .mosi_io_num = CONFIG_LED_PANEL_DATA,
-        .miso_io_num = -1,
-        .sclk_io_num = CONFIG_LED_PANEL_CLOCK,
-        .quadwp_io_num = -1,
-        .quadhd_io_num = -1,
-        .data4_io_num = -1,
-        .data5_io_num = -1,
-        .data6_io_num = -1,
-        .data7_io_num = -1,
-        .data_io_default_level = 0,
-        .max_transfer_sz = SPI_MAX_DMA_LEN,
-        .flags = SPICOMMON_BUSFLAG_MASTER | SPICOMMON_BUSFLAG_GPIO_PINS | SPICOMMON_BUSFLAG_SCLK | SPICOMMON_BUSFLAG_MOSI,
-        .isr_cpu_id = ESP_INTR_CPU_AFFINITY_AUTO,
-        .intr_flags = 0
-    };
-    ESP_ERROR_CHECK(spi_bus_initialize(SPI3_HOST, &spi_bus_config, SPI_DMA_CH_AUTO));
+    for (int chain = 0; chain < CHAIN_NB; chain++)
+    {
+        spi_bus_config_t spi_bus_config = {
+            .mosi_io_num = _chain_data[chain],
+            .miso_io_num = -1,
+            .sclk_io_num = _chain_clock[chain],
+            .quadwp_io_num = -1,
+            .quadhd_io_num = -1,
+            .data4_io_num = -1,
+            .data5_io_num = -1,
+            .data6_io_num = -1,
+            .data7_io_num = -1,
+            .data_io_default_level = 0,
+            .max_transfer_sz = SPI_MAX_DMA_LEN,
+            .flags = SPICOMMON_BUSFLAG_MASTER | SPICOMMON_BUSFLAG_GPIO_PINS | SPICOMMON_BUSFLAG_SCLK | SPICOMMON_BUSFLAG_MOSI,
+            .isr_cpu_id = ESP_INTR_CPU_AFFINITY_AUTO,
+            .intr_flags = 0
+        };
+        ESP_ERROR_CHECK(spi_bus_initialize(_chain_hosts[chain], &spi_bus_config, SPI_DMA_CH_AUTO));
+    }
 #endif
 
-#ifdef CONFIG_LED_PANEL_INTERFACE_GPIO
+#ifdef CONFIG_LED_PANEL_INTERFACE_GPIO_LEVEL
     gpio_reset_pin(static_cast<gpio_num_t>(CONFIG_LED_PANEL_LATCH));
     gpio_set_direction(static_cast<gpio_num_t>(CONFIG_LED_PANEL_LATCH), GPIO_MODE_OUTPUT);
     gpio_set_level(static_cast<gpio_num_t>(CONFIG_LED_PANEL_LATCH), LOW);
+#elif CONFIG_LED_PANEL_SPLIT_CHAIN
+    // LATCH is no longer a chip select, it idles high as it did and drops while the chains shift
+    gpio_reset_pin(static_cast<gpio_num_t>(CONFIG_LED_PANEL_LATCH));
+    gpio_set_direction(static_cast<gpio_num_t>(CONFIG_LED_PANEL_LATCH), GPIO_MODE_OUTPUT);
+    gpio_set_level(static_cast<gpio_num_t>(CONFIG_LED_PANEL_LATCH), 1);
 #endif
 #ifdef CONFIG_LED_PANEL_INTERFACE_SPI
-    spi_device_interface_config_t spi_device_interface_config = {
-        .command_bits = 0,
-        .address_bits = 0,
-        .dummy_bits = 0,
-        .mode = 0,
-        .clock_source = SPI_CLK_SRC_DEFAULT,
-        .duty_cycle_pos = 0,
-        .cs_ena_pretrans = 0,
-        .cs_ena_posttrans = 0,
-        .clock_speed_hz = CONFIG_LED_PANEL_INTERFACE_SPI_CLOCK_SPEED,
-        .input_delay_ns = 0,
-        .sample_point = SPI_SAMPLING_POINT_PHASE_0,
-        .spics_io_num = CONFIG_LED_PANEL_LATCH,
-        .flags = SPI_DEVICE_NO_DUMMY,
-        .queue_size = SPI_QUEUE_SIZE,
-        .pre_cb = nullptr,
-        .post_cb = nullptr
-    };
-    ESP_ERROR_CHECK(spi_bus_add_device(SPI3_HOST, &spi_device_interface_config, &m_spi));
+    for (int chain = 0; chain < CHAIN_NB; chain++)
+    {
+        spi_device_interface_config_t spi_device_interface_config = {
+            .command_bits = 0,
+            .address_bits = 0,
+            .dummy_bits = 0,
+            .mode = 0,
+            .clock_source = SPI_CLK_SRC_DEFAULT,
+            .duty_cycle_pos = 0,
+            .cs_ena_pretrans = 0,
+            .cs_ena_posttrans = 0,
+            .clock_speed_hz = CONFIG_LED_PANEL_INTERFACE_SPI_CLOCK_SPEED,
+            .input_delay_ns = 0,
+            .sample_point = SPI_SAMPLING_POINT_PHASE_0,
+#ifdef CONFIG_LED_PANEL_SPLIT_CHAIN
+            .spics_io_num = -1,
+#else
+            .spics_io_num = CONFIG_LED_PANEL_LATCH,
+#endif
+            .flags = SPI_DEVICE_NO_DUMMY,
+            .queue_size = SPI_QUEUE_SIZE,
+            .pre_cb = nullptr,
+#ifdef CONFIG_LED_PANEL_SPLIT_CHAIN
+            .post_cb = chain_done_cb
+#else
+            .post_cb = nullptr
+#endif
+        };
+        ESP_ERROR_CHECK(spi_bus_add_device(_chain_hosts[chain], &spi_device_interface_config, &m_spi[chain]));
+    }
 #endif
 
-    int32_t horizontal_resolution = CONFIG_LED_PANEL_MODULE_WIDTH * CONFIG_LED_PANEL_MATRIX_WIDTH;
-    int32_t vertical_resolution = CONFIG_LED_PANEL_MODULE_HEIGHT * CONFIG_LED_PANEL_MATRIX_HEIGHT;
+    int32_t horizontal_resolution = geometry_t::HORIZONTAL_RESOLUTION;
+    int32_t vertical_resolution = geometry_t::VERTICAL_RESOLUTION;
     ESP_LOGI(TAG, "Display resolution: %ld x %ld", horizontal_resolution, vertical_resolution);
 
-    m_panel_buffer_size = (vertical_resolution / PIXEL_PER_BYTE) * horizontal_resolution * sizeof(uint8_t);
+    m_panel_buffer_size = geometry_t::BUFFER_SIZE;
+#ifdef CONFIG_LED_PANEL_BCM_GRAYSCALE
+    // Bit-planes are stored back to back, plane 0 being the least significant
+    size_t panel_buffer_allocation = m_panel_buffer_size * CONFIG_LED_PANEL_BCM_BIT_DEPTH;
+#else
+    size_t panel_buffer_allocation = m_panel_buffer_size;
+#endif
 #if defined(CONFIG_SPIRAM)
-    ESP_LOGI(TAG, "Allocating m_panel_buffer in SPIRAM: %zu bytes", m_panel_buffer_size);
-    m_panel_buffer = static_cast<uint8_t*>(heap_caps_malloc(m_panel_buffer_size, MALLOC_CAP_SPIRAM));
+    ESP_LOGI(TAG, "Allocating m_panel_buffer in SPIRAM: %zu bytes", panel_buffer_allocation);
+    m_panel_buffer = static_cast<uint8_t*>(heap_caps_malloc(panel_buffer_allocation, MALLOC_CAP_SPIRAM));
 #else
-    ESP_LOGI(TAG, "Allocating m_panel_buffer in internal RAM: %zu bytes", m_panel_buffer_size);
-    m_panel_buffer = static_cast<uint8_t*>(heap_caps_malloc(m_panel_buffer_size, MALLOC_CAP_DMA));
+    ESP_LOGI(TAG, "Allocating m_panel_buffer in internal RAM: %zu bytes", panel_buffer_allocation);
+    m_panel_buffer = static_cast<uint8_t*>(heap_caps_malloc(panel_buffer_allocation, MALLOC_CAP_DMA));
 #endif
     if (m_panel_buffer == nullptr)
     {
         ESP_LOGE(TAG, "Failed to allocate m_panel_buffer on the heap!");
         return;
     }
+    memset(m_panel_buffer, 0, panel_buffer_allocation);
+    m_dirty_rows = 0xFF;
+
+#ifdef CONFIG_LED_PANEL_SPLIT_CHAIN
+    // DATA2/CLOCK2 can only be wired between two modules, each chain gets the same whole number of modules
+    static_assert((CONFIG_LED_PANEL_MODULE_WIDTH * CONFIG_LED_PANEL_MODULE_HEIGHT) % CHAIN_NB == 0,
+                  "The modules cannot be split evenly across the chains");
+    ESP_LOGI(TAG, "Split across %d chains of %zu bytes", CHAIN_NB, m_panel_buffer_size / CHAIN_NB);
+#endif
 
-    size_t lv_buffer_size = horizontal_resolution * vertical_resolution * BYTES_PER_PIXEL;
+#ifdef CONFIG_LED_PANEL_TYPE_MAX7219
+    m_transmit_buffer_size = ALL_DIGITS * CONFIG_LED_PANEL_MODULE_WIDTH * CONFIG_LED_PANEL_MODULE_HEIGHT * CONFIG_LED_PANEL_MAX7219_MODULE_CHIP_NB * sizeof(max_7219_buffer_t);
+#else
+    m_transmit_buffer_size = panel_buffer_allocation;
+#endif
+    ESP_LOGI(TAG, "Allocating %d transmit buffers in internal RAM: %zu bytes", TRANSMIT_BUFFER_NB, m_transmit_buffer_size);
+    m_transmit_slot = 0;
+    for (int slot = 0; slot < TRANSMIT_BUFFER_NB; slot++)
+    {
+        m_transmit_buffers[slot] = static_cast<uint8_t*>(heap_caps_malloc(m_transmit_buffer_size, MALLOC_CAP_DMA));
+        if (m_transmit_buffers[slot] == nullptr)
+        {
+            ESP_LOGE(TAG, "Failed to allocate m_transmit_buffers on the heap!");
+            return;
+        }
+#ifdef CONFIG_LED_PANEL_INTERFACE_SPI
+        m_in_flight[slot] = 0;
+#endif
+        memset(m_transmit_buffers[slot], 0, m_transmit_buffer_size);
+    }
+
+#ifdef CONFIG_LED_PANEL_RENDER_MODE_PARTIAL
+    int32_t lv_buffer_rows = CONFIG_LED_PANEL_PARTIAL_BUFFER_ROWS < vertical_resolution ? CONFIG_LED_PANEL_PARTIAL_BUFFER_ROWS : vertical_resolution;
+    lv_display_render_mode_t render_mode = LV_DISPLAY_RENDER_MODE_PARTIAL;
+#else
+    int32_t lv_buffer_rows = vertical_resolution;
+    lv_display_render_mode_t render_mode = LV_DISPLAY_RENDER_MODE_FULL;
+#endif
+#ifdef CONFIG_LED_PANEL_COLOR_FORMAT_I1
+    size_t lv_buffer_size = lv_draw_buf_width_to_stride(horizontal_resolution, LV_COLOR_FORMAT_I1) * lv_buffer_rows + I1_PALETTE_SIZE;
+#else
+    size_t lv_buffer_size = horizontal_resolution * lv_buffer_rows * BYTES_PER_PIXEL;
+#endif
 #if defined(CONFIG_SPIRAM)
     ESP_LOGI(TAG, "Allocating lvBuffer in SPIRAM: %zu bytes", lv_buffer_size);
     uint8_t *lv_buffer = static_cast<uint8_t*>(heap_caps_malloc(lv_buffer_size, MALLOC_CAP_SPIRAM));
@@ -206,17 +461,69 @@ LedPanel::LedPanel()
         return;
     }
 
+    reset_stats();
+    if (CONFIG_LED_PANEL_STATS_LOG_INTERVAL_SEC != 0)
+    {
+        esp_timer_create_args_t timer_args = {
+            .callback = stats_timer_callback,
+            .arg = this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "LedPanelStatsTimer",
+            .skip_unhandled_events = true
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &m_stats_timer));
+        ESP_ERROR_CHECK(esp_timer_start_periodic(m_stats_timer, CONFIG_LED_PANEL_STATS_LOG_INTERVAL_SEC * 1000000));
+    }
+
     m_display = lv_display_create(horizontal_resolution, vertical_resolution);
     lv_display_set_flush_cb(m_display, flush_cb);
     lv_display_set_user_data(m_display, this);
-    lv_display_set_buffers(m_display, lv_buffer, NULL, lv_buffer_size, LV_DISPLAY_RENDER_MODE_FULL);
+#ifdef CONFIG_LED_PANEL_COLOR_FORMAT_I1
+    lv_display_set_color_format(m_display, LV_COLOR_FORMAT_I1);
+#endif
+    lv_display_set_buffers(m_display, lv_buffer, NULL, lv_buffer_size, render_mode);
 
 #ifdef CONFIG_LED_PANEL_TYPE_MBI5026
+    uint32_t ledc_frequency = CONFIG_LED_PANEL_LEDC_FREQUENCY;
+    m_ledc_duty_resolution = CONFIG_LED_PANEL_LEDC_DUTY_RES;
+
+#ifdef CONFIG_LED_PANEL_BCM_GRAYSCALE
+    // Every subframe must be long enough to shift the next bit-plane in
+    uint32_t plane_transmit_us = static_cast<uint32_t>((static_cast<uint64_t>(m_panel_buffer_size) * PIXEL_PER_BYTE * 1000000) / CONFIG_LED_PANEL_INTERFACE_SPI_CLOCK_SPEED) + 1;
+    _bcm_base_us = CONFIG_LED_PANEL_BCM_BASE_US;
+    if (_bcm_base_us < plane_transmit_us)
+    {
+        ESP_LOGW(TAG, "BCM base on-time raised from %d us to %lu us, the time to shift one bit-plane", CONFIG_LED_PANEL_BCM_BASE_US, plane_transmit_us);
+        _bcm_base_us = plane_transmit_us;
+    }
+    ESP_LOGI(TAG, "BCM %d bits, refresh rate %lu Hz", CONFIG_LED_PANEL_BCM_BIT_DEPTH, 1000000 / (_bcm_base_us * ((1 << CONFIG_LED_PANEL_BCM_BIT_DEPTH) - 1)));
+
+    // LEDC keeps PWMing EN for the global intensity, the shortest subframe must span enough PWM periods
+    // for each bit-plane to be lit in proportion to its on-time, whatever the phase it starts at
+    uint32_t bcm_ledc_frequency = (BCM_LEDC_PERIODS_PER_BASE * 1000000 + _bcm_base_us - 1) / _bcm_base_us;
+    if (ledc_frequency < bcm_ledc_frequency)
+    {
+        ESP_LOGW(TAG, "LEDC frequency raised from %d Hz to %lu Hz, %d PWM periods per BCM base on-time", CONFIG_LED_PANEL_LEDC_FREQUENCY, bcm_ledc_frequency, BCM_LEDC_PERIODS_PER_BASE);
+        ledc_frequency = bcm_ledc_frequency;
+    }
+    uint32_t ledc_duty_resolution = ledc_find_suitable_duty_resolution(APB_CLK_FREQ, ledc_frequency);
+    if (ledc_duty_resolution == 0)
+    {
+        ESP_LOGE(TAG, "LEDC cannot run at %lu Hz, raise LED_PANEL_BCM_BASE_US", ledc_frequency);
+        return;
+    }
+    if (ledc_duty_resolution < m_ledc_duty_resolution)
+    {
+        ESP_LOGW(TAG, "LEDC duty resolution lowered from %d to %lu bits to run at %lu Hz", CONFIG_LED_PANEL_LEDC_DUTY_RES, ledc_duty_resolution, ledc_frequency);
+        m_ledc_duty_resolution = static_cast<uint8_t>(ledc_duty_resolution);
+    }
+#endif
+
     ledc_timer_config_t ledc_timer_conf = {
         .speed_mode = static_cast<ledc_mode_t>(CONFIG_LED_PANEL_LEDC_MODE),
-        .duty_resolution = static_cast<ledc_timer_bit_t>(CONFIG_LED_PANEL_LEDC_DUTY_RES),
+        .duty_resolution = static_cast<ledc_timer_bit_t>(m_ledc_duty_resolution),
         .timer_num = static_cast<ledc_timer_t>(CONFIG_LED_PANEL_LEDC_TIMER),
-        .freq_hz = CONFIG_LED_PANEL_LEDC_FREQUENCY,
+        .freq_hz = ledc_frequency,
         .clk_cfg = LEDC_AUTO_CLK,
         .deconfigure = 0
     };
@@ -240,6 +547,57 @@ LedPanel::LedPanel()
     ESP_ERROR_CHECK(ledc_set_duty(static_cast<ledc_mode_t>(CONFIG_LED_PANEL_LEDC_MODE), static_cast<ledc_channel_t>(CONFIG_LED_PANEL_LEDC_CHANNEL), CONFIG_LED_PANEL_INITIAL_DUTY_CYCLE));
     ESP_ERROR_CHECK(ledc_update_duty(static_cast<ledc_mode_t>(CONFIG_LED_PANEL_LEDC_MODE), static_cast<ledc_channel_t>(CONFIG_LED_PANEL_LEDC_CHANNEL)));
 
+#ifdef CONFIG_LED_PANEL_BCM_GRAYSCALE
+    m_bcm_active_slot = 0;
+    m_bcm_ready_slot = 0;
+    _bcm_plane = CONFIG_LED_PANEL_BCM_BIT_DEPTH - 1;
+    _bcm_bus_wanted = false;
+    _bcm_stop = false;
+
+    _bcm_bus_mutex = xSemaphoreCreateMutex();
+    _bcm_stopped = xSemaphoreCreateBinary();
+    if (_bcm_bus_mutex == nullptr || _bcm_stopped == nullptr)
+    {
+        ESP_LOGE(TAG, "Create BCM semaphores failure!");
+        return;
+    }
+
+    if (xTaskCreate(bcm_task, "ledPanelBcm", CONFIG_LED_PANEL_BCM_TASK_STACK_SIZE, this, CONFIG_LED_PANEL_BCM_TASK_PRIORITY, &_bcm_task_handle) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Create BCM task failure!");
+        return;
+    }
+
+    gptimer_config_t gptimer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = BCM_TIMER_RESOLUTION_HZ,
+        .intr_priority = 0,
+        .flags = {
+            .intr_shared = 0,
+            .allow_pd = 0,
+            .backup_before_sleep = 0
+        }
+    };
+    ESP_ERROR_CHECK(gptimer_new_timer(&gptimer_config, &_bcm_timer));
+
+    gptimer_event_callbacks_t gptimer_callbacks = {
+        .on_alarm = bcm_alarm_cb
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(_bcm_timer, &gptimer_callbacks, nullptr));
+    ESP_ERROR_CHECK(gptimer_enable(_bcm_timer));
+
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = _bcm_base_us,
+        .reload_count = 0,
+        .flags = {
+            .auto_reload_on_alarm = false
+        }
+    };
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(_bcm_timer, &alarm_config));
+    ESP_ERROR_CHECK(gptimer_start(_bcm_timer));
+#endif
+
 #elif CONFIG_LED_PANEL_TYPE_MAX7219
 
     xSemaphoreTake(_panel_buffer_mutex, portMAX_DELAY);
@@ -281,6 +639,15 @@ LedPanel::LedPanel()
     }
     send_buffer(m_max_7219_buffer, m_max_7219_buffer_len * sizeof(max_7219_buffer_t));
 
+    // Shadow copy of the digit registers, [digit][chip], matching the cleared registers below
+    m_max_7219_shadow = static_cast<uint8_t*>(heap_caps_calloc(ALL_DIGITS * m_max_7219_buffer_len, sizeof(uint8_t), MALLOC_CAP_DEFAULT));
+    if (m_max_7219_shadow == nullptr)
+    {
+        ESP_LOGE(TAG, "Failed to allocate m_max_7219_shadow on the heap!");
+        xSemaphoreGive(_panel_buffer_mutex);
+        return;
+    }
+
     for (int digit = 0; digit < ALL_DIGITS; digit++)
     {
         for (int chip = 0; chip < m_max_7219_buffer_len; chip++)
@@ -305,7 +672,6 @@ LedPanel::LedPanel()
     }
     send_buffer(m_max_7219_buffer, m_max_7219_buffer_len * sizeof(max_7219_buffer_t));
 
-    heap_caps_free(m_max_7219_buffer);
     xSemaphoreGive(_panel_buffer_mutex);
 
 #endif
@@ -313,12 +679,40 @@ LedPanel::LedPanel()
 
 LedPanel::~LedPanel()
 {
-#ifdef CONFIG_LED_PANEL_INTERFACE_GPIO
+    if (CONFIG_LED_PANEL_STATS_LOG_INTERVAL_SEC != 0)
+    {
+        esp_timer_stop(m_stats_timer);
+        esp_timer_delete(m_stats_timer);
+    }
+#ifdef CONFIG_LED_PANEL_BCM_GRAYSCALE
+    gptimer_stop(_bcm_timer);
+    gptimer_disable(_bcm_timer);
+    gptimer_del_timer(_bcm_timer);
+    _bcm_stop = true;
+    xTaskNotifyGive(_bcm_task_handle);
+    xSemaphoreTake(_bcm_stopped, portMAX_DELAY);
+    vSemaphoreDelete(_bcm_stopped);
+    vSemaphoreDelete(_bcm_bus_mutex);
+#endif
+    wait_transmit_done();
+    for (int slot = 0; slot < TRANSMIT_BUFFER_NB; slot++)
+    {
+        heap_caps_free(m_transmit_buffers[slot]);
+    }
+#ifdef CONFIG_LED_PANEL_TYPE_MAX7219
+    heap_caps_free(m_max_7219_buffer);
+    heap_caps_free(m_max_7219_shadow);
+#endif
+#ifdef CONFIG_LED_PANEL_INTERFACE_GPIO_DEDICATED
+    dedic_gpio_del_bundle(_bundle);
 #endif
 #ifdef CONFIG_LED_PANEL_INTERFACE_SPI
     vSemaphoreDelete(_panel_buffer_mutex);
-    spi_bus_remove_device(m_spi);
-    spi_bus_free(SPI3_HOST);
+    for (int chain = 0; chain < CHAIN_NB; chain++)
+    {
+        spi_bus_remove_device(m_spi[chain]);
+        spi_bus_free(_chain_hosts[chain]);
+    }
 #endif
 }
 
@@ -340,33 +734,73 @@ void LedPanel::set_buffer(uint16_t index, uint8_t buffer)
 }
 
 #ifdef CONFIG_LED_PANEL_INTERFACE_GPIO
-static void clk()
-{
-    gpio_set_level(static_cast<gpio_num_t>(CONFIG_LED_PANEL_CLOCK), HIGH);
-    gpio_set_level(static_cast<gpio_num_t>(CONFIG_LED_PANEL_CLOCK), LOW);
-}
+#ifdef CONFIG_LED_PANEL_INTERFACE_GPIO_DEDICATED
+// SHIFT_* bits follow the order of the bundle GPIOs, a write is a single CPU instruction
+typedef struct {
+    inline void write(uint32_t mask, uint32_t value)
+    {
+        dedic_gpio_cpu_ll_write_mask(mask << _bundle_offset, value << _bundle_offset);
+    }
+    inline void hold()
+    {
+        uint32_t start = esp_cpu_get_cycle_count();
+        while (esp_cpu_get_cycle_count() - start < HOLD_CYCLES)
+        {
+        }
+    }
+} panel_pins_t;
+#else
+// The clock goes low before the data changes, gpio_set_level() is slow enough to need no hold
+typedef struct {
+    inline void write(uint32_t mask, uint32_t value)
+    {
+        if (mask & SHIFT_CLOCK)
+        {
+            gpio_set_level(static_cast<gpio_num_t>(CONFIG_LED_PANEL_CLOCK), (value & SHIFT_CLOCK) ? HIGH : LOW);
+        }
+        if (mask & SHIFT_DATA)
+        {
+            gpio_set_level(static_cast<gpio_num_t>(CONFIG_LED_PANEL_DATA), (value & SHIFT_DATA) ? HIGH : LOW);
+        }
+        if (mask & SHIFT_LATCH)
+        {
+            gpio_set_level(static_cast<gpio_num_t>(CONFIG_LED_PANEL_LATCH), (value & SHIFT_LATCH) ? HIGH : LOW);
+        }
+    }
+    inline void hold()
+    {
+    }
+} panel_pins_t;
+#endif
 
-static void send_data(uint8_t data)
+void LedPanel::send_buffer(void *buffer, size_t buffer_size)
 {
-    for (int8_t pixel = 0; pixel < PIXEL_PER_BYTE; pixel++)
+#ifdef CONFIG_LED_PANEL_INTERFACE_GPIO_DEDICATED
+    if (esp_cpu_get_core_id() != _bundle_core)
     {
-        gpio_set_level(static_cast<gpio_num_t>(CONFIG_LED_PANEL_DATA), data & 0x80);
-        clk();
-        data = data << 1;
+        ESP_LOGE(TAG, "Dedicated GPIO bundle belongs to core %d, pin the LVGL task to it", _bundle_core);
+        return;
     }
+#endif
+    panel_pins_t pins;
+    shift_out(pins, static_cast<uint8_t *>(buffer), buffer_size);
 }
 
-void LedPanel::send_buffer(void *buffer, size_t buffer_size)
+// Bit banging is synchronous, there is never anything left to wait for
+void LedPanel::transmit(void *buffer, size_t buffer_size)
+{
+    int64_t transmit_start_us = esp_timer_get_time();
+    send_buffer(buffer, buffer_size);
+    m_stats.bus_wait_us += esp_timer_get_time() - transmit_start_us;
+    m_stats.bytes_transmitted += buffer_size;
+}
+
+void LedPanel::wait_transmit_done(uint8_t slot)
 {
-    uint8_t *current_data = static_cast<uint8_t *>(buffer);
+}
 
-    gpio_set_level(static_cast<gpio_num_t>(CONFIG_LED_PANEL_LATCH), LOW);
-    for (int8_t buffer_index = 0; buffer_index < buffer_size; buffer_index++)
-    {
-        send_data(*current_data);
-        current_data++;
-    }
-    gpio_set_level(static_cast<gpio_num_t>(CONFIG_LED_PANEL_LATCH), HIGH);
+void LedPanel::wait_transmit_done()
+{
 }
 #endif
 
@@ -375,11 +809,92 @@ void LedPanel::send_buffer(void *buffer, size_t buffer_size)
 {
     // ESP_LOG_BUFFER_HEX(TAG, buffer, bufferSize);
 
+    // spi_device_transmit() must not be mixed with transactions still queued
+    wait_transmit_done();
+
+#ifdef CONFIG_LED_PANEL_SPLIT_CHAIN
+    transmit(buffer, buffer_size);
+    wait_transmit_done();
+#else
+#ifdef CONFIG_LED_PANEL_BCM_GRAYSCALE
+    // The refresh task reaps its bit-plane and lets go of the bus at its next subframe
+    _bcm_bus_wanted = true;
+    xSemaphoreTake(_bcm_bus_mutex, portMAX_DELAY);
+#endif
     spi_transaction_t spi_transaction = {};
     spi_transaction.length = buffer_size * PIXEL_PER_BYTE;
     spi_transaction.tx_buffer = buffer;
     spi_transaction.rx_buffer = nullptr;
-    ESP_ERROR_CHECK(spi_device_transmit(m_spi, &spi_transaction));
+    ESP_ERROR_CHECK(spi_device_transmit(m_spi[0], &spi_transaction));
+#ifdef CONFIG_LED_PANEL_BCM_GRAYSCALE
+    _bcm_bus_wanted = false;
+    xSemaphoreGive(_bcm_bus_mutex);
+#endif
+#endif
+}
+
+#ifdef CONFIG_LED_PANEL_SPLIT_CHAIN
+// Queues one half of buffer on each chain, the last one to finish raises the shared latch.
+// The previous frame must be latched before either chain starts shifting this one.
+void LedPanel::transmit(void *buffer, size_t buffer_size)
+{
+    wait_transmit_done((m_transmit_slot + 1) % TRANSMIT_BUFFER_NB);
+
+    size_t chain_size = buffer_size / CHAIN_NB;
+    m_chain_pending[m_transmit_slot] = CHAIN_NB;
+    gpio_set_level(static_cast<gpio_num_t>(CONFIG_LED_PANEL_LATCH), 0);
+
+    for (int chain = 0; chain < CHAIN_NB; chain++)
+    {
+        spi_transaction_t *spi_transaction = &m_spi_transactions[m_transmit_slot][chain];
+        *spi_transaction = {};
+        spi_transaction->length = chain_size * PIXEL_PER_BYTE;
+        spi_transaction->tx_buffer = static_cast<uint8_t*>(buffer) + (CHAIN_NB - 1 - chain) * chain_size;
+        spi_transaction->rx_buffer = nullptr;
+        spi_transaction->user = &m_chain_pending[m_transmit_slot];
+        ESP_ERROR_CHECK(spi_device_queue_trans(m_spi[chain], spi_transaction, portMAX_DELAY));
+    }
+    m_in_flight[m_transmit_slot] += CHAIN_NB;
+    m_stats.bytes_transmitted += buffer_size;
+}
+#else
+// Queues buffer, which must stay untouched until wait_transmit_done() is called on the current slot
+void LedPanel::transmit(void *buffer, size_t buffer_size)
+{
+    assert(m_in_flight[m_transmit_slot] < FRAME_TRANSACTION_NB);
+
+    spi_transaction_t *spi_transaction = &m_spi_transactions[m_transmit_slot][m_in_flight[m_transmit_slot]];
+    *spi_transaction = {};
+    spi_transaction->length = buffer_size * PIXEL_PER_BYTE;
+    spi_transaction->tx_buffer = buffer;
+    spi_transaction->rx_buffer = nullptr;
+    ESP_ERROR_CHECK(spi_device_queue_trans(m_spi[0], spi_transaction, portMAX_DELAY));
+    m_in_flight[m_transmit_slot]++;
+    m_stats.bytes_transmitted += buffer_size;
+}
+#endif
+
+// Transactions complete in the order they were queued, the slots being used in turn
+// the oldest results always belong to the slot about to be reused.
+// A split frame has one transaction per chain, each chain is reaped on its own device.
+void LedPanel::wait_transmit_done(uint8_t slot)
+{
+    spi_transaction_t *spi_transaction;
+    int64_t wait_start_us = esp_timer_get_time();
+    while (m_in_flight[slot] > 0)
+    {
+        m_in_flight[slot]--;
+        ESP_ERROR_CHECK(spi_device_get_trans_result(m_spi[m_in_flight[slot] % CHAIN_NB], &spi_transaction, portMAX_DELAY));
+    }
+    m_stats.bus_wait_us += esp_timer_get_time() - wait_start_us;
+}
+
+void LedPanel::wait_transmit_done()
+{
+    for (int slot = 0; slot < TRANSMIT_BUFFER_NB; slot++)
+    {
+        wait_transmit_done((m_transmit_slot + slot) % TRANSMIT_BUFFER_NB);
+    }
 }
 #endif
 
@@ -388,44 +903,69 @@ void LedPanel::send_buffer()
     // ESP_LOG_BUFFER_HEX(TAG, m_panelBuffer, m_panelBufferSize);
     // ESP_LOGI(TAG, "--- %d", CONFIG_LED_PANEL_INTERFACE_SPI_CLOCK_SPEED);
 
-    #ifdef CONFIG_LED_PANEL_TYPE_MBI5026
-    send_buffer(m_panel_buffer, m_panel_buffer_size);
+    if (m_dirty_rows == 0)
+    {
+        return;
+    }
+
+#ifdef CONFIG_LED_PANEL_BCM_GRAYSCALE
+    // The refresh task owns the transmission, publish the bit-planes for its next cycle
+    uint8_t slot = 1 - m_bcm_active_slot;
+    memcpy(m_transmit_buffers[slot], m_panel_buffer, m_transmit_buffer_size);
+    m_bcm_ready_slot = slot;
+    m_dirty_rows = 0;
+    m_stats.bytes_transmitted += m_transmit_buffer_size;
+    return;
+#endif
+
+    // The frame is copied into a transmit buffer so that packing the next one can start right away
+    wait_transmit_done(m_transmit_slot);
+    uint8_t *transmit_buffer = m_transmit_buffers[m_transmit_slot];
+
+#ifdef CONFIG_LED_PANEL_TYPE_MBI5026
+    // MBI5026 modules are plain shift registers, a changed frame always shifts the whole chain
+    memcpy(transmit_buffer, m_panel_buffer, m_panel_buffer_size);
+    transmit(transmit_buffer, m_panel_buffer_size);
 #elif CONFIG_LED_PANEL_TYPE_MAX7219
 
-    for (int reg_digit = 0; reg_digit < ALL_DIGITS; reg_digit++)
+    // The transmit buffer holds one frame per digit register, [digit][chip].
+    // Chips whose digit register did not change get a NO-OP so that only the others latch a new value.
+    max_7219_buffer_t *max_7219_buffer = reinterpret_cast<max_7219_buffer_t*>(transmit_buffer);
+    uint8_t changed_digits = 0;
+    for (int chip = 0; chip < m_max_7219_buffer_len; chip++)
     {
-        // TODO Is this needed here?
-        if (m_max_7219_buffer == nullptr)
+        uint64_t digits = columns_to_digits(m_panel_buffer + chip * ALL_BITS);
+        for (int reg_digit = 0; reg_digit < ALL_DIGITS; reg_digit++)
         {
-            ESP_LOGE(TAG, "Failed to allocate m_max_7219_buffer on the heap!");
-            return;
+            uint8_t data = static_cast<uint8_t>(digits >> (8 * (ALL_DIGITS - 1 - reg_digit)));
+            uint8_t *shadow = &m_max_7219_shadow[reg_digit * m_max_7219_buffer_len + chip];
+            max_7219_buffer_t *max_7219_register = &max_7219_buffer[reg_digit * m_max_7219_buffer_len + chip];
+            if (data != *shadow)
+            {
+                *shadow = data;
+                max_7219_register->command = REG_DIGIT_0 + reg_digit;
+                max_7219_register->data = data;
+                changed_digits |= 1 << reg_digit;
+            }
+            else
+            {
+                max_7219_register->command = REG_NO_OP;
+                max_7219_register->data = 0;
+            }
         }
+    }
 
-        // TODO Fix this as lv_memset_00 is no longer available
-        // lv_memset_00(m_max_7219_buffer, m_max_7219_buffer_len * sizeof(Max7219Buffer_t));
-        uint8_t *panel_buffer = m_panel_buffer;
-        for (int chip = 0; chip < m_max_7219_buffer_len; chip++)
+    for (int reg_digit = 0; reg_digit < ALL_DIGITS; reg_digit++)
+    {
+        if (changed_digits & (1 << reg_digit))
         {
-            m_max_7219_buffer[chip].command = REG_DIGIT_0 + reg_digit;
-            uint8_t segment = 0x80;
-            for (uint8_t x_bit = 0; x_bit < ALL_BITS; x_bit++)
-            {
-                if (*panel_buffer & (0x80 >> reg_digit))
-                {
-                    m_max_7219_buffer[chip].data |= segment;
-                }
-                else
-                {
-                    m_max_7219_buffer[chip].data &= ~segment;
-                }
-                segment >>= 1;
-                panel_buffer++;
-            }
+            transmit(&max_7219_buffer[reg_digit * m_max_7219_buffer_len], m_max_7219_buffer_len * sizeof(max_7219_buffer_t));
         }
-        send_buffer(m_max_7219_buffer, m_max_7219_buffer_len * sizeof(max_7219_buffer_t));
     }
 
 #endif
+    m_transmit_slot = (m_transmit_slot + 1) % TRANSMIT_BUFFER_NB;
+    m_dirty_rows = 0;
 }
 
 void LedPanel::set_intensity(float intensity)
@@ -440,7 +980,7 @@ void LedPanel::set_intensity(float intensity)
     }
 
 #ifdef CONFIG_LED_PANEL_TYPE_MBI5026
-    uint32_t duty_cycle = (intensity * (1 << CONFIG_LED_PANEL_LEDC_DUTY_RES));
+    uint32_t duty_cycle = (intensity * (1 << m_ledc_duty_resolution));
     ESP_ERROR_CHECK(ledc_set_duty(static_cast<ledc_mode_t>(CONFIG_LED_PANEL_LEDC_MODE), static_cast<ledc_channel_t>(CONFIG_LED_PANEL_LEDC_CHANNEL), duty_cycle));
     ESP_ERROR_CHECK(ledc_update_duty(static_cast<ledc_mode_t>(CONFIG_LED_PANEL_LEDC_MODE), static_cast<ledc_channel_t>(CONFIG_LED_PANEL_LEDC_CHANNEL)));
 #elif CONFIG_LED_PANEL_TYPE_MAX7219
@@ -455,3 +995,63 @@ void LedPanel::set_intensity(float intensity)
     xSemaphoreGive(_panel_buffer_mutex);
 #endif
 }
+
+led_panel_stats_t LedPanel::get_stats()
+{
+    xSemaphoreTake(_panel_buffer_mutex, portMAX_DELAY);
+    led_panel_stats_t stats = m_stats;
+    uint64_t flush_total_us = m_flush_total_us;
+    int64_t elapsed_us = esp_timer_get_time() - m_stats_start_us;
+    xSemaphoreGive(_panel_buffer_mutex);
+
+    if (stats.flush_count == 0)
+    {
+        stats.flush_min_us = 0;
+    }
+    else
+    {
+        stats.flush_avg_us = static_cast<uint32_t>(flush_total_us / stats.flush_count);
+    }
+    stats.fps = elapsed_us > 0 ? stats.frame_count * 1000000.0f / elapsed_us : 0.0f;
+    return stats;
+}
+
+void LedPanel::reset_stats()
+{
+    xSemaphoreTake(_panel_buffer_mutex, portMAX_DELAY);
+    m_stats = {};
+    m_stats.flush_min_us = UINT32_MAX;
+    m_flush_total_us = 0;
+    m_stats_start_us = esp_timer_get_time();
+    xSemaphoreGive(_panel_buffer_mutex);
+}
+
+// Run length encoded copy of the panel buffer, see ledPanelSnapshot.hpp, length is set to the needed size even when it does not fit
+esp_err_t LedPanel::get_snapshot(uint8_t *buffer, size_t size, size_t *length)
+{
+#ifdef CONFIG_LED_PANEL_BCM_GRAYSCALE
+    const uint8_t plane_nb = CONFIG_LED_PANEL_BCM_BIT_DEPTH;
+#else
+    const uint8_t plane_nb = 1;
+#endif
+    xSemaphoreTake(_panel_buffer_mutex, portMAX_DELAY);
+    size_t snapshot_length = snapshot::encode_panel<geometry_t>(m_panel_buffer, plane_nb, buffer, size);
+    xSemaphoreGive(_panel_buffer_mutex);
+
+    if (length != nullptr)
+    {
+        *length = snapshot_length;
+    }
+    return snapshot_length <= size ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+void LedPanel::stats_timer_callback(void *arg)
+{
+    LedPanel *ledPanel = static_cast<LedPanel*>(arg);
+    led_panel_stats_t stats = ledPanel->get_stats();
+    ledPanel->reset_stats();
+
+    ESP_LOGI(TAG, "%lu flushes, %.1f fps, flush %lu/%lu/%lu us (min/avg/max), bus wait %llu us, %llu pixels, %llu bytes",
+             stats.flush_count, stats.fps, stats.flush_min_us, stats.flush_avg_us, stats.flush_max_us,
+             stats.bus_wait_us, stats.pixels_converted, stats.bytes_transmitted);
+}
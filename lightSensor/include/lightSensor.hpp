@@ -77,6 +77,7 @@ namespace macdap
         esp_err_t get_illuminance(uint16_t *illuminance, intensity_status_t *intensity_status = nullptr);
         esp_err_t set_measure_time(const uint8_t measure_time);
         esp_err_t add_lv_obj_icon(lv_obj_t *lv_obj_icon);
+        uint32_t get_suppressed_updates();
         esp_err_t register_event_handler(esp_event_handler_t event_handler, void* handler_arg = nullptr);
         esp_err_t unregister_event_handler(esp_event_handler_t event_handler);
     };
@@ -14,35 +14,28 @@ static const char *TAG = "lightSensor";
 
 ESP_EVENT_DEFINE_BASE(LIGHT_SENSOR_EVENTS);
 
+static uint32_t _suppressed_updates = 0;
+
+// Intensity icons by status then size, 16 then 32
+static constexpr const lv_image_dsc_t *_intensity_icons[][2] = {
+    {&sun_dim_thin_16, &sun_dim_thin_32},   // Lowest
+    {&sun_dim_16, &sun_dim_32},             // Low
+    {&sun_16, &sun_32},                     // Medium
+    {&sun_bold_16, &sun_bold_32},           // High
+    {&sun_fill_16, &sun_fill_32}            // Highest
+};
+static_assert(sizeof(_intensity_icons) / sizeof(_intensity_icons[0]) == Highest + 1, "One row per intensity_status_t");
+
 static void update_status(lv_obj_t *icon, intensity_status_t intensity_status)
 {
     lv_coord_t height = lv_obj_get_height(icon);
 
+    const size_t row = static_cast<size_t>(intensity_status) <= static_cast<size_t>(Highest) ? static_cast<size_t>(intensity_status) : static_cast<size_t>(Medium);
     const lv_image_dsc_t *icon_src = nullptr;
     switch(height)
     {
-        case 32:
-            switch (intensity_status)
-            {
-                case Lowest:  icon_src = &sun_dim_thin_32; break;
-                case Low:     icon_src = &sun_dim_32; break;
-                case Medium:  icon_src = &sun_32; break;
-                case High:    icon_src = &sun_bold_32; break;
-                case Highest: icon_src = &sun_fill_32; break;
-                default:      icon_src = &sun_32; break;
-            }
-        break;
-        case 16:
-            switch (intensity_status)
-            {
-                case Lowest:  icon_src = &sun_dim_thin_16; break;
-                case Low:     icon_src = &sun_dim_16; break;
-                case Medium:  icon_src = &sun_16; break;
-                case High:    icon_src = &sun_bold_16; break;
-                case Highest: icon_src = &sun_fill_16; break;
-                default:      icon_src = &sun_16; break;
-            }
-        break;
+        case 32: icon_src = _intensity_icons[row][1]; break;
+        case 16: icon_src = _intensity_icons[row][0]; break;
         default:
             ESP_LOGE(TAG, "Unexpected Intensity icon height: %d", height);
         break;
@@ -50,7 +43,11 @@ static void update_status(lv_obj_t *icon, intensity_status_t intensity_status)
 
     if (icon_src != nullptr) {
         if (lvgl_port_lock(0)) {
-            lv_img_set_src(icon, icon_src);
+            if (lv_image_get_src(icon) != icon_src) {
+                lv_img_set_src(icon, icon_src);
+            } else {
+                _suppressed_updates++;
+            }
             lvgl_port_unlock();
         }
     }
@@ -239,6 +236,12 @@ esp_err_t LightSensor::set_measure_time(const uint8_t measure_time)
     return ESP_OK;
 }
 
+// Icon updates skipped because the icon already showed the intensity
+uint32_t LightSensor::get_suppressed_updates()
+{
+    return _suppressed_updates;
+}
+
 esp_err_t LightSensor::add_lv_obj_icon(lv_obj_t *lv_obj_icon)
 {
     if (lv_obj_icon == nullptr) {
@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <oledDisplayPages.hpp>
+
+#define WIDTH 128
+#define HEIGHT 64
+#define ITERATIONS 200
+
+namespace pages = macdap::pages;
+
+typedef std::vector<bool> image_t;
+
+// Panel bit of a lit logical pixel, mapped independently of the geometry policy
+template <bool MIRROR_X, bool MIRROR_Y>
+static void reference_pixel(uint8_t *frame, int32_t x, int32_t y, bool lit)
+{
+    const int32_t column = MIRROR_X ? WIDTH - 1 - x : x;
+    const int32_t row = MIRROR_Y ? HEIGHT - 1 - y : y;
+    const uint8_t bit = static_cast<uint8_t>(1 << (row % 8));
+    uint8_t &target = frame[(row / 8) * WIDTH + column];
+    target = lit ? target | bit : target & ~bit;
+}
+
+// The panel as flush_cb leaves it, m_frame being what it shows
+template <bool MIRROR_X, bool MIRROR_Y>
+struct panel_t
+{
+    typedef pages::page_geometry<WIDTH, HEIGHT, MIRROR_X, MIRROR_Y> geometry_t;
+
+    uint8_t shown[geometry_t::BUFFER_SIZE] = {};
+    uint8_t page[WIDTH];
+    bool minimal = true;
+
+    // The area as the rounder leaves it, whole pages, returns the bytes sent
+    uint32_t flush(const image_t &image, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+    {
+        y1 &= ~(pages::PAGE_ROWS - 1);
+        y2 |= pages::PAGE_ROWS - 1;
+        const pages::window_t columns = pages::panel_columns<geometry_t>(x1, x2);
+        const pages::window_t panel_pages = pages::panel_pages<geometry_t>(y1, y2);
+
+        uint32_t bytes = 0;
+        for (int32_t panel_page = panel_pages.x1; panel_page <= panel_pages.x2; panel_page++)
+        {
+            uint8_t *shown_columns = shown + panel_page * WIDTH;
+            memcpy(page + columns.x1, shown_columns + columns.x1, columns.x2 - columns.x1 + 1);
+
+            // This page of the area, shifted so that the reference can address it as a whole frame
+            uint8_t *page_frame = page - panel_page * WIDTH;
+            for (int32_t y = y1; y <= y2; y++)
+            {
+                const int32_t row = MIRROR_Y ? HEIGHT - 1 - y : y;
+                if (row / pages::PAGE_ROWS != panel_page)
+                {
+                    continue;
+                }
+                for (int32_t x = x1; x <= x2; x++)
+                {
+                    reference_pixel<MIRROR_X, MIRROR_Y>(page_frame, x, y, image[y * WIDTH + x]);
+                }
+            }
+
+            uint8_t previous[WIDTH];
+            memcpy(previous, shown_columns, WIDTH);
+            pages::window_t window;
+            if (pages::dirty_window(page, shown_columns, columns.x1, columns.x2, window))
+            {
+                minimal = minimal && page[window.x1] != previous[window.x1] && page[window.x2] != previous[window.x2];
+                bytes += window.x2 - window.x1 + 1;
+            }
+        }
+        return bytes;
+    }
+
+    bool shows(const image_t &image) const
+    {
+        uint8_t expected[geometry_t::BUFFER_SIZE] = {};
+        for (int32_t y = 0; y < HEIGHT; y++)
+        {
+            for (int32_t x = 0; x < WIDTH; x++)
+            {
+                reference_pixel<MIRROR_X, MIRROR_Y>(expected, x, y, image[y * WIDTH + x]);
+            }
+        }
+        return memcmp(expected, shown, sizeof(shown)) == 0;
+    }
+};
+
+// A 10x16 digit, made of the segments of a seven segment display
+static void draw_digit(image_t &image, int32_t left, int32_t top, int digit)
+{
+    static const uint8_t SEGMENTS[10] = {0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F};
+    const uint8_t segments = SEGMENTS[digit];
+    for (int32_t y = 0; y < 16; y++)
+    {
+        for (int32_t x = 0; x < 10; x++)
+        {
+            const bool top_half = y < 8;
+            const bool lit =
+                ((segments & 0x01) && y < 2) ||
+                ((segments & 0x02) && x >= 8 && top_half) ||
+                ((segments & 0x04) && x >= 8 && !top_half) ||
+                ((segments & 0x08) && y >= 14) ||
+                ((segments & 0x10) && x < 2 && !top_half) ||
+                ((segments & 0x20) && x < 2 && top_half) ||
+                ((segments & 0x40) && (y == 7 || y == 8));
+            image[(top + y) * WIDTH + left + x] = lit;
+        }
+    }
+}
+
+static void draw_clock(image_t &image, int hours, int minutes)
+{
+    const int digits[4] = {hours / 10, hours % 10, minutes / 10, minutes % 10};
+    for (int index = 0; index < 4; index++)
+    {
+        draw_digit(image, 36 + index * 14 + (index >= 2 ? 4 : 0), 24, digits[index]);
+    }
+}
+
+// Random LVGL I1 areas, palette already skipped, a pixel being lit when its bit is clear
+template <bool MIRROR_X, bool MIRROR_Y>
+static void verify_pack()
+{
+    typedef pages::page_geometry<WIDTH, HEIGHT, MIRROR_X, MIRROR_Y> geometry_t;
+
+    bool match = true;
+    for (int iteration = 0; iteration < ITERATIONS && match; iteration++)
+    {
+        // Any columns, unaligned rows as well as the page aligned ones of the rounder
+        int32_t x1 = rand() % WIDTH;
+        int32_t x2 = x1 + rand() % (WIDTH - x1);
+        int32_t y1 = rand() % HEIGHT;
+        int32_t y2 = y1 + rand() % (HEIGHT - y1);
+        if (iteration % 2)
+        {
+            y1 &= ~(pages::PAGE_ROWS - 1);
+            y2 |= pages::PAGE_ROWS - 1;
+        }
+        const size_t stride = (x2 - x1 + 1 + 7) / 8;
+        std::vector<uint8_t> px_map(stride * (y2 - y1 + 1));
+        for (auto &byte : px_map)
+        {
+            byte = static_cast<uint8_t>(rand());
+        }
+
+        // Whatever the panel showed before, bits outside the area must stay
+        std::vector<uint8_t> reference(geometry_t::BUFFER_SIZE);
+        for (auto &byte : reference)
+        {
+            byte = static_cast<uint8_t>(rand());
+        }
+        std::vector<uint8_t> packed = reference;
+
+        for (int32_t y = y1; y <= y2; y++)
+        {
+            for (int32_t x = x1; x <= x2; x++)
+            {
+                const int32_t column = x - x1;
+                const bool lit = (px_map[(y - y1) * stride + column / 8] & (0x80 >> (column % 8))) == 0;
+                reference_pixel<MIRROR_X, MIRROR_Y>(reference.data(), x, y, lit);
+            }
+        }
+        const pages::window_t panel_pages = pages::panel_pages<geometry_t>(y1, y2);
+        for (int32_t page = panel_pages.x1; page <= panel_pages.x2; page++)
+        {
+            pages::pack_page_i1<geometry_t>(packed.data() + page * WIDTH, page, x1, y1, x2, y2, px_map.data(), stride);
+        }
+        match = packed == reference;
+    }
+    printf("pack_page_i1  mirror x %d  mirror y %d  %s\n", MIRROR_X, MIRROR_Y, match ? "match" : "MISMATCH");
+}
+
+template <bool MIRROR_X, bool MIRROR_Y>
+static void replay()
+{
+    panel_t<MIRROR_X, MIRROR_Y> panel;
+    image_t image(WIDTH * HEIGHT, false);
+
+    // A header line and a footer line around the clock
+    for (int32_t x = 0; x < WIDTH; x++)
+    {
+        image[6 * WIDTH + x] = true;
+        image[57 * WIDTH + x] = x % 4 != 0;
+    }
+    draw_clock(image, 12, 59);
+    uint32_t full_bytes = panel.flush(image, 0, 0, WIDTH - 1, HEIGHT - 1);
+    bool match = panel.shows(image);
+
+    // LVGL invalidates the whole clock label, only the changed digits go out
+    draw_clock(image, 13, 0);
+    uint32_t hour_bytes = panel.flush(image, 36, 24, 95, 39);
+    match = match && panel.shows(image);
+    draw_clock(image, 13, 1);
+    uint32_t minute_bytes = panel.flush(image, 36, 24, 95, 39);
+    match = match && panel.shows(image);
+
+    // Redrawn without any change
+    uint32_t unchanged_bytes = panel.flush(image, 0, 16, WIDTH - 1, 47);
+    match = match && panel.shows(image) && unchanged_bytes == 0;
+
+    // A single pixel
+    image[33 * WIDTH + 5] = true;
+    uint32_t pixel_bytes = panel.flush(image, 5, 33, 5, 33);
+    match = match && panel.shows(image) && pixel_bytes == 1;
+
+    printf("dirty_window  mirror x %d  mirror y %d  full %4lu  hour %3lu  minute %3lu  unchanged %lu  pixel %lu bytes  %s\n",
+           MIRROR_X, MIRROR_Y, static_cast<unsigned long>(full_bytes), static_cast<unsigned long>(hour_bytes), static_cast<unsigned long>(minute_bytes),
+           static_cast<unsigned long>(unchanged_bytes), static_cast<unsigned long>(pixel_bytes), match && panel.minimal ? "match" : "MISMATCH");
+}
+
+extern "C" void app_main(void)
+{
+    printf("OLED page benchmark, %dx%d\n", WIDTH, HEIGHT);
+
+    verify_pack<false, false>();
+    verify_pack<true, false>();
+    verify_pack<false, true>();
+    verify_pack<true, true>();
+
+    replay<false, false>();
+    replay<true, true>();
+}
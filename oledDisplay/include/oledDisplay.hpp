@@ -1,18 +1,68 @@
 #pragma once
 
+#include "sdkconfig.h"
 #include "esp_err.h"
 #include "esp_lvgl_port.h"
+#include <esp_lcd_panel_io.h>
+#include <esp_timer.h>
 
 namespace macdap
 {
+    typedef enum {
+        OledControllerSSD1306,
+        OledControllerSSD1309,
+        OledControllerSH1106
+    } oled_controller_t;
+
+    typedef struct {
+        const char *name;
+        uint8_t column_offset;          // First visible column of the controller RAM
+        const uint8_t *init;            // Sent after the commands common to all the controllers
+        size_t init_size;
+    } oled_controller_descriptor_t;
+
+    typedef struct {
+        uint32_t flush_count;
+        uint32_t frame_count;           // A frame being one or more flushes
+        uint64_t pixels_converted;
+        uint64_t bytes_transmitted;
+        uint32_t flush_min_us;
+        uint32_t flush_avg_us;
+        uint32_t flush_max_us;
+        uint64_t bus_wait_us;           // Flushes sending to the panel and waiting for the transfers to complete
+        float fps;
+    } oled_display_stats_t;
+
     class Display
     {
 
     private:
         bool m_is_present;
         lv_display_t *m_lv_display;
+        SemaphoreHandle_t m_stats_mutex;
+        oled_display_stats_t m_stats;
+        uint64_t m_flush_total_us;
+        int64_t m_stats_start_us;
+        int64_t m_flush_start_us;
+        esp_timer_handle_t m_stats_timer;
+        esp_lcd_panel_io_handle_t m_io_handle;
+        const oled_controller_descriptor_t *m_controller;
+        SemaphoreHandle_t m_transfer_done;
+        uint32_t m_transfer_nb;
+        SemaphoreHandle_t m_frame_mutex;
+        uint8_t *m_lv_buffer;
+        uint8_t m_frame[CONFIG_OLED_DISPLAY_WIDTH * CONFIG_OLED_DISPLAY_HEIGHT / 8];    // SSD1306 pages, as sent to the panel
+        uint8_t m_page[CONFIG_OLED_DISPLAY_WIDTH];                                      // Page being packed
         Display();
         ~Display();
+        static void flush_event_cb(lv_event_t *event);
+        static void stats_timer_callback(void *arg);
+        static void rounder_event_cb(lv_event_t *event);
+        static void flush_cb(lv_display_t *lv_display, const lv_area_t *area, uint8_t *px_map);
+        void send_command(uint8_t command);
+        void send_window(int32_t page, int32_t x1, int32_t x2);
+        void wait_transfers();
+        void init_controller();
 
     public:
         Display(Display const&) = delete;
@@ -24,5 +74,10 @@ namespace macdap
         }
         bool is_present() const { return m_is_present; }
         lv_display_t *get_lv_display();
+        oled_controller_t get_controller();
+        esp_err_t set_controller(oled_controller_t controller);
+        oled_display_stats_t get_stats();
+        void reset_stats();
+        esp_err_t get_snapshot(uint8_t *buffer, size_t size, size_t *length);
     };
 }
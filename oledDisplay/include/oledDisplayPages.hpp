@@ -0,0 +1,132 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Packing of LVGL I1 pixels into the SSD1306 page layout, and search of the columns that changed since the last transfer.
+// A page is a band of 8 rows, one byte per column, the LSB being the top row of the band.
+// A pixel is lit when its I1 bit is clear, the way esp_lvgl_port has always shown LVGL screens on the OLED.
+// How LVGL coordinates land on the panel is a compile time geometry policy, so the mirroring costs nothing.
+// examples/pagesBenchmark checks it on the host.
+
+namespace macdap
+{
+    namespace pages
+    {
+        static constexpr int32_t PAGE_ROWS = 8;
+
+        // WIDTH x HEIGHT is the panel as wired, the content being mirrored by MIRROR_X and MIRROR_Y
+        template <int32_t WIDTH, int32_t HEIGHT, bool MIRROR_X = false, bool MIRROR_Y = false>
+        struct page_geometry
+        {
+            static_assert(WIDTH > 0 && HEIGHT > 0 && HEIGHT % PAGE_ROWS == 0, "Panel height must be a multiple of 8 rows");
+
+            static constexpr int32_t HORIZONTAL_RESOLUTION = WIDTH;
+            static constexpr int32_t VERTICAL_RESOLUTION = HEIGHT;
+            static constexpr size_t BUFFER_SIZE = (HEIGHT / PAGE_ROWS) * WIDTH;
+
+            static constexpr int32_t column(int32_t x)
+            {
+                return MIRROR_X ? WIDTH - 1 - x : x;
+            }
+
+            static constexpr int32_t row(int32_t y)
+            {
+                return MIRROR_Y ? HEIGHT - 1 - y : y;
+            }
+
+            // Logical row shown on a panel row, mirroring being its own inverse
+            static constexpr int32_t logical_row(int32_t row)
+            {
+                return MIRROR_Y ? HEIGHT - 1 - row : row;
+            }
+
+            static constexpr size_t index(int32_t x, int32_t y)
+            {
+                return (row(y) / PAGE_ROWS) * WIDTH + column(x);
+            }
+
+            static constexpr uint8_t bit(int32_t, int32_t y)
+            {
+                return static_cast<uint8_t>(1 << (row(y) % PAGE_ROWS));
+            }
+        };
+
+        // Panel columns x1..x2, or panel pages y1..y2
+        typedef struct {
+            int32_t x1;
+            int32_t x2;
+        } window_t;
+
+        template <typename geometry_t>
+        static inline window_t panel_columns(int32_t x1, int32_t x2)
+        {
+            int32_t column_1 = geometry_t::column(x1);
+            int32_t column_2 = geometry_t::column(x2);
+            return column_1 <= column_2 ? window_t{column_1, column_2} : window_t{column_2, column_1};
+        }
+
+        template <typename geometry_t>
+        static inline window_t panel_pages(int32_t y1, int32_t y2)
+        {
+            int32_t page_1 = geometry_t::row(y1) / PAGE_ROWS;
+            int32_t page_2 = geometry_t::row(y2) / PAGE_ROWS;
+            return page_1 <= page_2 ? window_t{page_1, page_2} : window_t{page_2, page_1};
+        }
+
+        // Packs the rows of the area x1..x2, y1..y2 of an LVGL I1 buffer (palette already skipped) that land on a page.
+        // page_columns holds the whole page, indexed by panel column, bits outside the area are left as they are.
+        template <typename geometry_t>
+        static inline void pack_page_i1(uint8_t *page_columns, int32_t page, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const uint8_t *px_map, size_t stride)
+        {
+            for (int32_t row = page * PAGE_ROWS; row < (page + 1) * PAGE_ROWS; row++)
+            {
+                const int32_t y = geometry_t::logical_row(row);
+                if (y < y1 || y > y2)
+                {
+                    continue;
+                }
+                const uint8_t *pixels = px_map + (y - y1) * stride;
+                const uint8_t bit = static_cast<uint8_t>(1 << (row % PAGE_ROWS));
+                for (int32_t x = x1; x <= x2; x++)
+                {
+                    const int32_t column = x - x1;
+                    uint8_t &target = page_columns[geometry_t::column(x)];
+                    if (pixels[column / 8] & (0x80 >> (column % 8)))
+                    {
+                        target &= ~bit;
+                    }
+                    else
+                    {
+                        target |= bit;
+                    }
+                }
+            }
+        }
+
+        // Narrows columns x1..x2 of a page to the ones that differ from what the panel shows, which is then updated
+        static inline bool dirty_window(const uint8_t *page_columns, uint8_t *shown_columns, int32_t x1, int32_t x2, window_t &window)
+        {
+            while (x1 <= x2 && page_columns[x1] == shown_columns[x1])
+            {
+                x1++;
+            }
+            while (x2 >= x1 && page_columns[x2] == shown_columns[x2])
+            {
+                x2--;
+            }
+            if (x1 > x2)
+            {
+                return false;
+            }
+
+            for (int32_t x = x1; x <= x2; x++)
+            {
+                shown_columns[x] = page_columns[x];
+            }
+            window.x1 = x1;
+            window.x2 = x2;
+            return true;
+        }
+    }
+}
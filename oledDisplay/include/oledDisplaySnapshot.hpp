@@ -0,0 +1,21 @@
+#pragma once
+
+#include <snapshot.hpp>
+
+// Snapshot of a frame in the SSD1306 page layout of oledDisplayPages.hpp, in the '1' format of snapshot.hpp.
+
+namespace macdap
+{
+    namespace snapshot
+    {
+        // Pixels of a page frame of geometry_t::BUFFER_SIZE bytes, in LVGL coordinates
+        template <typename geometry_t>
+        static inline size_t encode_pages(const uint8_t *frame, uint8_t *buffer, size_t size)
+        {
+            return encode_1bpp(geometry_t::HORIZONTAL_RESOLUTION, geometry_t::VERTICAL_RESOLUTION,
+                [frame](int32_t x, int32_t y) {
+                    return (frame[geometry_t::index(x, y)] & geometry_t::bit(x, y)) != 0;
+                }, buffer, size);
+        }
+    }
+}
@@ -2,98 +2,498 @@
 #include "freertos/FreeRTOS.h"
 #include <freertos/task.h>
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#ifdef CONFIG_OLED_DISPLAY_INTERFACE_I2C
 #include <driver/i2c_master.h>
+#elif CONFIG_OLED_DISPLAY_INTERFACE_SPI
+#include <driver/spi_master.h>
+#endif
 #include <esp_lcd_panel_io.h>
 #include <lvgl.h>
-#include <esp_lcd_panel_dev.h>
-#include "esp_lcd_panel_vendor.h"
-#include <esp_lcd_panel_ssd1306.h>
+#include <esp_heap_caps.h>
+#include <oledDisplayPages.hpp>
+#include <oledDisplaySnapshot.hpp>
+#include <string.h>
 
 using namespace macdap;
 
-#define LCD_PIXEL_CLOCK_HZ    (400 * 1000)
-
 #define LCD_CMD_BITS           8
 #define LCD_PARAM_BITS         8
 
+#ifdef CONFIG_OLED_DISPLAY_INTERFACE_SPI
+#define SPI_QUEUE_SIZE         (CONFIG_OLED_DISPLAY_HEIGHT / 8)
+#endif
+
+#define CMD_DISPLAY_OFF        0xAE
+#define CMD_DISPLAY_ON         0xAF
+#define CMD_PAGE_ADDRESS       0xB0
+#define CMD_COLUMN_LOW         0x00
+#define CMD_COLUMN_HIGH        0x10
+
+#define I1_PALETTE_SIZE (LV_COLOR_INDEXED_PALETTE_SIZE(LV_COLOR_FORMAT_I1) * sizeof(lv_color32_t))
+
+#ifdef CONFIG_OLED_DISPLAY_MIRROR_X
+#define DISPLAY_MIRROR_X true
+#else
+#define DISPLAY_MIRROR_X false
+#endif
+
+#ifdef CONFIG_OLED_DISPLAY_MIRROR_Y
+#define DISPLAY_MIRROR_Y true
+#else
+#define DISPLAY_MIRROR_Y false
+#endif
+
+typedef pages::page_geometry<CONFIG_OLED_DISPLAY_WIDTH, CONFIG_OLED_DISPLAY_HEIGHT, DISPLAY_MIRROR_X, DISPLAY_MIRROR_Y> geometry_t;
+
 static const char *TAG = "display";
 
+// Commands common to the SSD1306, SSD1309 and SH1106, the segments and COM scan being left unmirrored
+static const uint8_t _common_init[] = {
+    CMD_DISPLAY_OFF,
+    0xD5, 0x80,                                 // Clock divide ratio and oscillator frequency
+    0xA8, CONFIG_OLED_DISPLAY_HEIGHT - 1,       // Multiplex ratio
+    0xD3, 0x00,                                 // Display offset
+    0x40,                                       // Start line 0
+    0xA0,                                       // Segment remap off
+    0xC0,                                       // COM scan from COM0
+    0xDA, CONFIG_OLED_DISPLAY_HEIGHT == 64 ? 0x12 : 0x02,   // COM pins, alternate for 64 rows
+    0x81, 0x7F,                                 // Contrast
+    0xA4,                                       // Display follows RAM
+    0xA6                                        // Not inverted
+};
+
+// Page addressing is set explicitly on the SSD130x, it is the only mode of the SH1106
+static const uint8_t _ssd1306_init[] = {
+    0x20, 0x02,                                 // Page addressing
+    0x8D, 0x14,                                 // Charge pump on
+    0xD9, 0xF1,                                 // Pre-charge period
+    0xDB, 0x40                                  // VCOMH deselect level
+};
+
+static const uint8_t _ssd1309_init[] = {
+    0xFD, 0x12,                                 // Command unlock, VCC comes from outside, there is no charge pump
+    0x20, 0x02,                                 // Page addressing
+    0xD9, 0xF1,                                 // Pre-charge period
+    0xDB, 0x40                                  // VCOMH deselect level
+};
+
+static const uint8_t _sh1106_init[] = {
+    0xAD, 0x8B,                                 // DC-DC converter on
+    0x32,                                       // Pump voltage 8 V
+    0xD9, 0x22,                                 // Pre-charge period
+    0xDB, 0x35                                  // VCOMH deselect level
+};
+
+// The SH1106 has 132 columns of RAM, the 128 visible ones start at column 2
+static const oled_controller_descriptor_t _controllers[] = {
+    {"SSD1306", 0, _ssd1306_init, sizeof(_ssd1306_init)},
+    {"SSD1309", 0, _ssd1309_init, sizeof(_ssd1309_init)},
+    {"SH1106", 2, _sh1106_init, sizeof(_sh1106_init)}
+};
+
+#ifdef CONFIG_OLED_DISPLAY_CONTROLLER_SSD1309
+#define DEFAULT_CONTROLLER OledControllerSSD1309
+#elif CONFIG_OLED_DISPLAY_CONTROLLER_SH1106
+#define DEFAULT_CONTROLLER OledControllerSH1106
+#else
+#define DEFAULT_CONTROLLER OledControllerSSD1306
+#endif
+
+// Called from the SPI interrupt, or from the task itself on I2C
+static bool color_transfer_done(esp_lcd_panel_io_handle_t io_handle, esp_lcd_panel_io_event_data_t *event_data, void *user_ctx)
+{
+    BaseType_t task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(static_cast<SemaphoreHandle_t>(user_ctx), &task_woken);
+    return task_woken == pdTRUE;
+}
+
+// Invalidated areas are stretched to page boundaries, so that a page is packed and sent once per refresh
+void Display::rounder_event_cb(lv_event_t *event)
+{
+    lv_area_t *area = static_cast<lv_area_t*>(lv_event_get_param(event));
+    area->y1 = area->y1 & ~(pages::PAGE_ROWS - 1);
+    area->y2 = area->y2 | (pages::PAGE_ROWS - 1);
+}
+
+// Commands are sent one at a time, so that they go with D/C low on SPI as well as on I2C
+void Display::send_command(uint8_t command)
+{
+    esp_lcd_panel_io_tx_param(m_io_handle, command, nullptr, 0);
+}
+
+// Sends columns x1..x2 of a page from m_frame, which has to be left as is until wait_transfers() returns.
+// The Display instance is static, m_frame is in internal RAM where the SPI DMA can read it.
+void Display::send_window(int32_t page, int32_t x1, int32_t x2)
+{
+    const int32_t column = x1 + m_controller->column_offset;
+    send_command(CMD_PAGE_ADDRESS | page);
+    send_command(CMD_COLUMN_LOW | (column & 0x0F));
+    send_command(CMD_COLUMN_HIGH | (column >> 4));
+    esp_lcd_panel_io_tx_color(m_io_handle, -1, m_frame + page * CONFIG_OLED_DISPLAY_WIDTH + x1, x2 - x1 + 1);
+    m_transfer_nb++;
+}
+
+// SPI transfers are queued, I2C ones are done by the time tx_color returns
+void Display::wait_transfers()
+{
+    for (; m_transfer_nb > 0; m_transfer_nb--)
+    {
+        xSemaphoreTake(m_transfer_done, portMAX_DELAY);
+    }
+}
+
+// Caller holds the frame mutex, the panel is left blank with m_frame matching it
+void Display::init_controller()
+{
+    for (uint8_t command : _common_init)
+    {
+        send_command(command);
+    }
+    for (size_t index = 0; index < m_controller->init_size; index++)
+    {
+        send_command(m_controller->init[index]);
+    }
+
+    // The panel RAM holds noise after a reset
+    memset(m_frame, 0, sizeof(m_frame));
+    for (int32_t page = 0; page < CONFIG_OLED_DISPLAY_HEIGHT / pages::PAGE_ROWS; page++)
+    {
+        send_window(page, 0, CONFIG_OLED_DISPLAY_WIDTH - 1);
+    }
+    wait_transfers();
+    send_command(CMD_DISPLAY_ON);
+}
+
+// Packs the I1 area straight into SSD1306 pages, mirrored as the panel is mounted.
+// Only the columns of each page that differ from what the panel shows go over the bus.
+void Display::flush_cb(lv_display_t *lv_display, const lv_area_t *area, uint8_t *px_map)
+{
+    Display *display = static_cast<Display*>(lv_display_get_user_data(lv_display));
+    const uint32_t stride = lv_draw_buf_width_to_stride(lv_area_get_width(area), LV_COLOR_FORMAT_I1);
+    const pages::window_t columns = pages::panel_columns<geometry_t>(area->x1, area->x2);
+    const pages::window_t panel_pages = pages::panel_pages<geometry_t>(area->y1, area->y2);
+    uint32_t bytes_transmitted = 0;
+    int64_t bus_us = 0;
+
+    xSemaphoreTake(display->m_frame_mutex, portMAX_DELAY);
+    for (int32_t page = panel_pages.x1; page <= panel_pages.x2; page++)
+    {
+        uint8_t *shown = display->m_frame + page * CONFIG_OLED_DISPLAY_WIDTH;
+        memcpy(display->m_page + columns.x1, shown + columns.x1, columns.x2 - columns.x1 + 1);
+        // LVGL places the palette ahead of the indexed pixels
+        pages::pack_page_i1<geometry_t>(display->m_page, page, area->x1, area->y1, area->x2, area->y2, px_map + I1_PALETTE_SIZE, stride);
+
+        pages::window_t window;
+        if (pages::dirty_window(display->m_page, shown, columns.x1, columns.x2, window))
+        {
+            // The commands, and on I2C the pixels, are sent before send_window() returns
+            int64_t send_start_us = esp_timer_get_time();
+            display->send_window(page, window.x1, window.x2);
+            bus_us += esp_timer_get_time() - send_start_us;
+            bytes_transmitted += window.x2 - window.x1 + 1;
+        }
+    }
+    int64_t wait_start_us = esp_timer_get_time();
+    display->wait_transfers();
+    bus_us += esp_timer_get_time() - wait_start_us;
+    xSemaphoreGive(display->m_frame_mutex);
+
+    xSemaphoreTake(display->m_stats_mutex, portMAX_DELAY);
+    display->m_stats.bytes_transmitted += bytes_transmitted;
+    display->m_stats.bus_wait_us += bus_us;
+    xSemaphoreGive(display->m_stats_mutex);
+
+    // The transfers are done, and there may have been none
+    lv_display_flush_ready(lv_display);
+}
+
+// The flush path is timed through the LVGL display events
+void Display::flush_event_cb(lv_event_t *event)
+{
+    Display *display = static_cast<Display*>(lv_event_get_user_data(event));
+    int64_t now_us = esp_timer_get_time();
+
+    xSemaphoreTake(display->m_stats_mutex, portMAX_DELAY);
+    switch (lv_event_get_code(event))
+    {
+        case LV_EVENT_FLUSH_START:
+        {
+            const lv_area_t *area = static_cast<const lv_area_t*>(lv_event_get_param(event));
+            uint32_t pixels = lv_area_get_size(area);
+            display->m_flush_start_us = now_us;
+            display->m_stats.pixels_converted += pixels;
+            break;
+        }
+        case LV_EVENT_FLUSH_FINISH:
+        {
+            uint32_t flush_us = static_cast<uint32_t>(now_us - display->m_flush_start_us);
+            display->m_stats.flush_count++;
+            if (lv_display_flush_is_last(display->m_lv_display))
+            {
+                display->m_stats.frame_count++;
+            }
+            display->m_flush_total_us += flush_us;
+            if (flush_us < display->m_stats.flush_min_us)
+            {
+                display->m_stats.flush_min_us = flush_us;
+            }
+            if (flush_us > display->m_stats.flush_max_us)
+            {
+                display->m_stats.flush_max_us = flush_us;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    xSemaphoreGive(display->m_stats_mutex);
+}
+
+void Display::stats_timer_callback(void *arg)
+{
+    Display *display = static_cast<Display*>(arg);
+    oled_display_stats_t stats = display->get_stats();
+    display->reset_stats();
+
+    ESP_LOGI(TAG, "%lu flushes, %.1f fps, flush %lu/%lu/%lu us (min/avg/max), bus wait %llu us, %llu pixels, %llu bytes",
+             stats.flush_count, stats.fps, stats.flush_min_us, stats.flush_avg_us, stats.flush_max_us,
+             stats.bus_wait_us, stats.pixels_converted, stats.bytes_transmitted);
+}
+
 Display::Display()
 {
     ESP_LOGI(TAG, "Initializing...");
 
     m_is_present = false;
     m_lv_display = nullptr;
+    m_io_handle = nullptr;
+    m_controller = &_controllers[DEFAULT_CONTROLLER];
+    m_transfer_nb = 0;
+    m_lv_buffer = nullptr;
+    memset(m_frame, 0, sizeof(m_frame));
 
+    m_frame_mutex = xSemaphoreCreateMutex();
+    if (m_frame_mutex == nullptr)
+    {
+        ESP_LOGE(TAG, "Create frame mutex failure!");
+        return;
+    }
+
+    m_stats_mutex = xSemaphoreCreateMutex();
+    if (m_stats_mutex == nullptr)
+    {
+        ESP_LOGE(TAG, "Create stats mutex failure!");
+        return;
+    }
+    reset_stats();
+
+    m_transfer_done = xSemaphoreCreateCounting(CONFIG_OLED_DISPLAY_HEIGHT / pages::PAGE_ROWS, 0);
+    if (m_transfer_done == nullptr)
+    {
+        ESP_LOGE(TAG, "Create transfer semaphore failure!");
+        return;
+    }
+
+#ifdef CONFIG_OLED_DISPLAY_INTERFACE_I2C
     i2c_master_bus_handle_t i2c_master_bus_handle;
-    ESP_ERROR_CHECK(i2c_master_get_bus_handle(0, &i2c_master_bus_handle));
+    ESP_ERROR_CHECK(i2c_master_get_bus_handle(static_cast<i2c_port_num_t>(CONFIG_OLED_DISPLAY_I2C_PORT), &i2c_master_bus_handle));
 
     if (i2c_master_probe(i2c_master_bus_handle, CONFIG_OLED_DISPLAY_I2C_ADDR, 100) != ESP_OK)
     {
-        ESP_LOGW(TAG, "SSD1306 not found at address 0x%02X", CONFIG_OLED_DISPLAY_I2C_ADDR);
+        ESP_LOGW(TAG, "%s not found at address 0x%02X", m_controller->name, CONFIG_OLED_DISPLAY_I2C_ADDR);
         return;
     }
 
-    ESP_LOGI(TAG, "Found SSD1306 at address 0x%02X", CONFIG_OLED_DISPLAY_I2C_ADDR);
-    m_is_present = true;
+    ESP_LOGI(TAG, "Found %s at address 0x%02X", m_controller->name, CONFIG_OLED_DISPLAY_I2C_ADDR);
 
-    esp_lcd_panel_io_i2c_config_t i2c_config;
+    esp_lcd_panel_io_i2c_config_t i2c_config = {};
     i2c_config.dev_addr = CONFIG_OLED_DISPLAY_I2C_ADDR;
-    i2c_config.scl_speed_hz = LCD_PIXEL_CLOCK_HZ;
+    i2c_config.scl_speed_hz = CONFIG_OLED_DISPLAY_I2C_CLOCK_SPEED;
     i2c_config.control_phase_bytes = 1;               // According to SSD1306 datasheet
     i2c_config.lcd_cmd_bits = LCD_CMD_BITS;           // According to SSD1306 datasheet
-    i2c_config.lcd_param_bits = LCD_CMD_BITS;         // According to SSD1306 datasheet
+    i2c_config.lcd_param_bits = LCD_PARAM_BITS;       // According to SSD1306 datasheet
     i2c_config.dc_bit_offset = 6;                     // According to SSD1306 datasheet
+    ESP_ERROR_CHECK(esp_lcd_new_panel_io_i2c(i2c_master_bus_handle, &i2c_config, &m_io_handle));
+#elif CONFIG_OLED_DISPLAY_INTERFACE_SPI
+    // The SPI controllers cannot be probed, the panel is assumed to be there
+    spi_bus_config_t spi_bus_config = {};
+    spi_bus_config.mosi_io_num = CONFIG_OLED_DISPLAY_SPI_MOSI;
+    spi_bus_config.miso_io_num = -1;
+    spi_bus_config.sclk_io_num = CONFIG_OLED_DISPLAY_SPI_CLOCK;
+    spi_bus_config.quadwp_io_num = -1;
+    spi_bus_config.quadhd_io_num = -1;
+    spi_bus_config.max_transfer_sz = CONFIG_OLED_DISPLAY_WIDTH;
+    ESP_ERROR_CHECK(spi_bus_initialize(static_cast<spi_host_device_t>(CONFIG_OLED_DISPLAY_SPI_HOST), &spi_bus_config, SPI_DMA_CH_AUTO));
+
+    esp_lcd_panel_io_spi_config_t spi_config = {};
+    spi_config.cs_gpio_num = CONFIG_OLED_DISPLAY_SPI_CS;
+    spi_config.dc_gpio_num = CONFIG_OLED_DISPLAY_SPI_DC;
+    spi_config.spi_mode = 0;
+    spi_config.pclk_hz = CONFIG_OLED_DISPLAY_SPI_CLOCK_SPEED;
+    spi_config.trans_queue_depth = SPI_QUEUE_SIZE;
+    spi_config.lcd_cmd_bits = LCD_CMD_BITS;
+    spi_config.lcd_param_bits = LCD_PARAM_BITS;
+    ESP_ERROR_CHECK(esp_lcd_new_panel_io_spi(static_cast<esp_lcd_spi_bus_handle_t>(CONFIG_OLED_DISPLAY_SPI_HOST), &spi_config, &m_io_handle));
+    ESP_LOGI(TAG, "%s on SPI at %d Hz", m_controller->name, CONFIG_OLED_DISPLAY_SPI_CLOCK_SPEED);
+#endif
+    m_is_present = true;
+
+    esp_lcd_panel_io_callbacks_t callbacks = {};
+    callbacks.on_color_trans_done = color_transfer_done;
+    ESP_ERROR_CHECK(esp_lcd_panel_io_register_event_callbacks(m_io_handle, &callbacks, m_transfer_done));
+
+    if (CONFIG_OLED_DISPLAY_GPIO_RESET >= 0)
+    {
+        gpio_config_t reset_config = {};
+        reset_config.pin_bit_mask = 1ULL << CONFIG_OLED_DISPLAY_GPIO_RESET;
+        reset_config.mode = GPIO_MODE_OUTPUT;
+        ESP_ERROR_CHECK(gpio_config(&reset_config));
+        gpio_set_level(static_cast<gpio_num_t>(CONFIG_OLED_DISPLAY_GPIO_RESET), 0);
+        vTaskDelay(pdMS_TO_TICKS(10));
+        gpio_set_level(static_cast<gpio_num_t>(CONFIG_OLED_DISPLAY_GPIO_RESET), 1);
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
 
-    esp_lcd_panel_io_handle_t io_handle = NULL;
-    ESP_ERROR_CHECK(esp_lcd_new_panel_io_i2c(i2c_master_bus_handle, &i2c_config, &io_handle));
-
-    esp_lcd_panel_dev_config_t dev_config;
-    dev_config.bits_per_pixel = 1;
-    dev_config.reset_gpio_num = CONFIG_OLED_DISPLAY_GPIO_RESET;
-
-    ESP_LOGI(TAG, "Install SSD1306 panel driver");
-    esp_lcd_panel_ssd1306_config_t ssd1306_config;
-    ssd1306_config.height = CONFIG_OLED_DISPLAY_HEIGHT;
-
-    esp_lcd_panel_handle_t panel_handle = NULL;
-
-    dev_config.vendor_config = &ssd1306_config;
-    ESP_ERROR_CHECK(esp_lcd_new_panel_ssd1306(io_handle, &dev_config, &panel_handle));
-    
-    ESP_ERROR_CHECK(esp_lcd_panel_reset(panel_handle));
-    ESP_ERROR_CHECK(esp_lcd_panel_init(panel_handle));
-    ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(panel_handle, true));
-
-    const lvgl_port_display_cfg_t port_display_cfg = {
-        .io_handle = io_handle,
-        .panel_handle = panel_handle,
-        .control_handle = nullptr,
-        .buffer_size = CONFIG_OLED_DISPLAY_WIDTH * CONFIG_OLED_DISPLAY_HEIGHT,
-        .double_buffer = true,
-        .trans_size = 0,
-        .hres = CONFIG_OLED_DISPLAY_WIDTH,
-        .vres = CONFIG_OLED_DISPLAY_HEIGHT,
-        .monochrome = true,
-        .rotation = {
-            .swap_xy = false,
-            .mirror_x = true,
-            .mirror_y = true,
-        },
-        .color_format = LV_COLOR_FORMAT_NATIVE,
-        .flags = {}
-    };
+    xSemaphoreTake(m_frame_mutex, portMAX_DELAY);
+    init_controller();
+    xSemaphoreGive(m_frame_mutex);
+
+    // A stripe of I1 rows, LVGL splitting larger areas, the pages themselves live in m_frame
+    int32_t lv_buffer_rows = CONFIG_OLED_DISPLAY_BUFFER_ROWS < CONFIG_OLED_DISPLAY_HEIGHT ? CONFIG_OLED_DISPLAY_BUFFER_ROWS : CONFIG_OLED_DISPLAY_HEIGHT;
+    size_t lv_buffer_size = lv_draw_buf_width_to_stride(CONFIG_OLED_DISPLAY_WIDTH, LV_COLOR_FORMAT_I1) * lv_buffer_rows + I1_PALETTE_SIZE;
+    ESP_LOGI(TAG, "Allocating lvBuffer of %ld rows in internal RAM: %zu bytes", lv_buffer_rows, lv_buffer_size);
+    m_lv_buffer = static_cast<uint8_t*>(heap_caps_malloc(lv_buffer_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    if (m_lv_buffer == nullptr)
+    {
+        ESP_LOGE(TAG, "Failed to allocate lvBuffer on the heap!");
+        return;
+    }
 
     ESP_LOGI(TAG, "Display resolution: %d x %d", CONFIG_OLED_DISPLAY_WIDTH, CONFIG_OLED_DISPLAY_HEIGHT);
 
-    m_lv_display = lvgl_port_add_disp(&port_display_cfg); // Warning "Callback on_color_trans_done was already set and now it was overwritten!" comes from this call.
+    lvgl_port_lock(0);
+    m_lv_display = lv_display_create(CONFIG_OLED_DISPLAY_WIDTH, CONFIG_OLED_DISPLAY_HEIGHT);
+    lv_display_set_color_format(m_lv_display, LV_COLOR_FORMAT_I1);
+    lv_display_set_flush_cb(m_lv_display, flush_cb);
+    lv_display_set_user_data(m_lv_display, this);
+    lv_display_set_buffers(m_lv_display, m_lv_buffer, nullptr, lv_buffer_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_add_event_cb(m_lv_display, rounder_event_cb, LV_EVENT_INVALIDATE_AREA, this);
+    lv_display_add_event_cb(m_lv_display, flush_event_cb, LV_EVENT_FLUSH_START, this);
+    lv_display_add_event_cb(m_lv_display, flush_event_cb, LV_EVENT_FLUSH_FINISH, this);
+    lvgl_port_unlock();
+
+    if (CONFIG_OLED_DISPLAY_STATS_LOG_INTERVAL_SEC != 0)
+    {
+        esp_timer_create_args_t timer_args = {
+            .callback = stats_timer_callback,
+            .arg = this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "DisplayStatsTimer",
+            .skip_unhandled_events = true
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &m_stats_timer));
+        ESP_ERROR_CHECK(esp_timer_start_periodic(m_stats_timer, CONFIG_OLED_DISPLAY_STATS_LOG_INTERVAL_SEC * 1000000));
+    }
 }
 
 Display::~Display()
 {
+    if (m_is_present && CONFIG_OLED_DISPLAY_STATS_LOG_INTERVAL_SEC != 0)
+    {
+        esp_timer_stop(m_stats_timer);
+        esp_timer_delete(m_stats_timer);
+    }
+    vSemaphoreDelete(m_stats_mutex);
+    vSemaphoreDelete(m_frame_mutex);
+    vSemaphoreDelete(m_transfer_done);
+    heap_caps_free(m_lv_buffer);
 }
 
 lv_display_t *Display::get_lv_display()
 {
     return m_lv_display;
 }
+
+oled_controller_t Display::get_controller()
+{
+    return static_cast<oled_controller_t>(m_controller - _controllers);
+}
+
+// For boards whose OLED is only known at runtime, the panel is initialized again and LVGL redraws the whole screen
+esp_err_t Display::set_controller(oled_controller_t controller)
+{
+    if (!m_is_present)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (controller < OledControllerSSD1306 || controller > OledControllerSH1106)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(m_frame_mutex, portMAX_DELAY);
+    send_command(CMD_DISPLAY_OFF);
+    m_controller = &_controllers[controller];
+    init_controller();
+    xSemaphoreGive(m_frame_mutex);
+    ESP_LOGI(TAG, "Controller set to %s", m_controller->name);
+
+    if (m_lv_display != nullptr && lvgl_port_lock(0))
+    {
+        lv_obj_invalidate(lv_display_get_screen_active(m_lv_display));
+        lvgl_port_unlock();
+    }
+    return ESP_OK;
+}
+
+oled_display_stats_t Display::get_stats()
+{
+    xSemaphoreTake(m_stats_mutex, portMAX_DELAY);
+    oled_display_stats_t stats = m_stats;
+    uint64_t flush_total_us = m_flush_total_us;
+    int64_t elapsed_us = esp_timer_get_time() - m_stats_start_us;
+    xSemaphoreGive(m_stats_mutex);
+
+    if (stats.flush_count == 0)
+    {
+        stats.flush_min_us = 0;
+    }
+    else
+    {
+        stats.flush_avg_us = static_cast<uint32_t>(flush_total_us / stats.flush_count);
+    }
+    stats.fps = elapsed_us > 0 ? stats.frame_count * 1000000.0f / elapsed_us : 0.0f;
+    return stats;
+}
+
+void Display::reset_stats()
+{
+    xSemaphoreTake(m_stats_mutex, portMAX_DELAY);
+    m_stats = {};
+    m_stats.flush_min_us = UINT32_MAX;
+    m_flush_total_us = 0;
+    m_stats_start_us = esp_timer_get_time();
+    xSemaphoreGive(m_stats_mutex);
+}
+
+// Run length encoded copy of what the panel shows, see snapshot.hpp for the format.
+// length is set to the needed size even when it does not fit.
+esp_err_t Display::get_snapshot(uint8_t *buffer, size_t size, size_t *length)
+{
+    if (!m_is_present)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(m_frame_mutex, portMAX_DELAY);
+    size_t snapshot_length = snapshot::encode_pages<geometry_t>(m_frame, buffer, size);
+    xSemaphoreGive(m_frame_mutex);
+
+    if (length != nullptr)
+    {
+        *length = snapshot_length;
+    }
+    return snapshot_length <= size ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
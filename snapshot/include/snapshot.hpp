@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Compressed snapshots of what a display shows, for monitoring it without moving the raw frame.
+// A snapshot is 'S', a format byte, the width and height as little endian uint16_t, then the encoded pixels in row order.
+// The '1' format of 1 bit frames is the lengths of the alternating runs of off and on pixels, starting with an off run
+// that may be empty, as LEB128 varints.
+
+namespace macdap
+{
+    namespace snapshot
+    {
+        // Counts the whole snapshot while only writing what fits, so that the needed size is known on overflow
+        typedef struct {
+            uint8_t *buffer;
+            size_t size;
+            size_t length;
+        } writer_t;
+
+        static inline void put(writer_t &writer, uint8_t byte)
+        {
+            if (writer.length < writer.size)
+            {
+                writer.buffer[writer.length] = byte;
+            }
+            writer.length++;
+        }
+
+        static inline void put_uint16(writer_t &writer, uint16_t value)
+        {
+            put(writer, static_cast<uint8_t>(value));
+            put(writer, static_cast<uint8_t>(value >> 8));
+        }
+
+        static inline void put_varint(writer_t &writer, uint32_t value)
+        {
+            while (value >= 0x80)
+            {
+                put(writer, static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            put(writer, static_cast<uint8_t>(value));
+        }
+
+        static inline void put_header(writer_t &writer, uint8_t format, uint16_t width, uint16_t height)
+        {
+            put(writer, 'S');
+            put(writer, format);
+            put_uint16(writer, width);
+            put_uint16(writer, height);
+        }
+
+        // is_on(x, y) reads a pixel of the already rendered frame, returns the snapshot length even if larger than size
+        template <typename is_on_t>
+        static inline size_t encode_1bpp(uint16_t width, uint16_t height, is_on_t is_on, uint8_t *buffer, size_t size)
+        {
+            writer_t writer = {buffer, size, 0};
+            put_header(writer, '1', width, height);
+
+            bool on = false;
+            uint32_t run = 0;
+            for (int32_t y = 0; y < height; y++)
+            {
+                for (int32_t x = 0; x < width; x++)
+                {
+                    if (is_on(x, y) != on)
+                    {
+                        put_varint(writer, run);
+                        on = !on;
+                        run = 0;
+                    }
+                    run++;
+                }
+            }
+            put_varint(writer, run);
+            return writer.length;
+        }
+    }
+}